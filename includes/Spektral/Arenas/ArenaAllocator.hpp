@@ -0,0 +1,116 @@
+#pragma once
+#include "LinearArena.hpp"
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+namespace Spektral::Arenas {
+
+/**
+ * @class ArenaAllocator
+ * @brief A stateful STL allocator that allocates from a LinearArena.
+ *
+ * Lets standard containers allocate from an arena:
+ *
+ *     Spektral::Arenas::LinearArena arena(1 << 20);
+ *     Spektral::Arenas::ArenaAllocator<int> alloc(arena);
+ *     std::vector<int, Spektral::Arenas::ArenaAllocator<int>> v(alloc);
+ *
+ * `deallocate` gives memory back to the arena when it frees the most recent
+ * allocation and is a no-op otherwise, everything else is reclaimed by
+ * `reset()`. Note that a growing container frees its old buffer after
+ * allocating the new one, so that buffer is only reclaimed by `reset()`. Two
+ * allocators compare equal when they share an arena.
+ *
+ * The allocator follows its container on move assignment and swap, so both
+ * stay O(1), but not on copy assignment: a container copied into keeps its
+ * own arena.
+ *
+ * @tparam T The type of object to allocate.
+ * @tparam Stats The stats policy of the arena, `NoStats` by default.
+ */
+template <typename T, class Stats = NoStats> class ArenaAllocator {
+public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  using is_always_equal = std::false_type;
+
+  /**
+   * @brief Rebinds the allocator to another type, sharing the same arena.
+   */
+  template <typename U> struct rebind {
+    using other = ArenaAllocator<U, Stats>;
+  };
+
+  /**
+   * @brief Deleted default constructor.
+   */
+  ArenaAllocator() = delete;
+
+  /**
+   * @brief Constructs an allocator for an arena.
+   * @param arena The arena to allocate from. Must outlive every container
+   * using the allocator.
+   */
+  explicit ArenaAllocator(BasicLinearArena<Stats> &arena) noexcept
+      : arena_(&arena) {}
+
+  /**
+   * @brief Converts an allocator for another type, sharing its arena.
+   */
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U, Stats> &other) noexcept
+      : arena_(other.arena_) {}
+
+  /**
+   * @brief Allocates memory for `count` objects of type T.
+   * @param count The number of objects to allocate.
+   * @return A pointer to the allocated memory.
+   *
+   * Throws std::bad_alloc if the arena is out of memory.
+   */
+  T *allocate(size_t count) {
+    if (count > std::numeric_limits<size_t>::max() / sizeof(T))
+      throw std::bad_array_new_length();
+    T *ptr = arena_->template alloc<T>(count);
+    if (!ptr)
+      throw std::bad_alloc();
+    return ptr;
+  }
+
+  /**
+   * @brief Gives memory back to the arena if it is the most recent
+   * allocation, does nothing otherwise.
+   * @param ptr The pointer returned by `allocate`.
+   * @param count The number of objects it was allocated for.
+   */
+  void deallocate(T *ptr, size_t count) noexcept {
+    arena_->rollback(ptr, sizeof(T) * count);
+  }
+
+  /**
+   * @brief Returns the arena allocations are served from.
+   */
+  BasicLinearArena<Stats> &arena() const noexcept { return *arena_; }
+
+  /**
+   * @brief Allocators are equal when they allocate from the same arena.
+   */
+  template <typename U>
+  friend bool operator==(const ArenaAllocator &lhs,
+                         const ArenaAllocator<U, Stats> &rhs) noexcept {
+    return &lhs.arena() == &rhs.arena();
+  }
+
+private:
+  template <typename U, class S> friend class ArenaAllocator;
+
+  BasicLinearArena<Stats> *arena_; ///< The arena to allocate from.
+};
+
+} // namespace Spektral::Arenas
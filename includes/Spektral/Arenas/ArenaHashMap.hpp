@@ -0,0 +1,340 @@
+#pragma once
+#include "LinearArena.hpp"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace Spektral::Arenas {
+
+/**
+ * @class ArenaHashMap
+ * @brief A flat, open-addressing hash map whose table lives in a
+ * `LinearArena`.
+ *
+ * SwissTable layout: every slot has a control byte holding either 7 bits of
+ * its hash, empty or deleted, and lookups compare a whole group of 16 control
+ * bytes at once (with SSE2 when available, a portable loop otherwise) before
+ * touching any key. Groups are probed quadratically.
+ *
+ * Keys and values are stored inline in the table, there is no node to
+ * allocate. `erase` only leaves a tombstone, and since keys and values have
+ * to be trivially destructible, destroying the map costs nothing: its memory
+ * goes away with the arena's next `reset()`. Growing moves the table to a
+ * new, larger block of the arena and the old one stays there until
+ * `reset()`, `reserve` up front avoids it.
+ *
+ * Operations that need memory report failure instead of throwing: `reserve`
+ * returns false and `try_emplace` returns a null value when the arena is
+ * full.
+ *
+ * @tparam K The type of the keys, trivially destructible.
+ * @tparam V The type of the values, trivially destructible.
+ * @tparam Hash The hash function. `std::hash<K>` by default.
+ * @tparam Eq The key equality. `std::equal_to<K>` by default.
+ * @tparam Stats The stats policy of the arena, `NoStats` by default.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>,
+          typename Eq = std::equal_to<K>, class Stats = NoStats>
+class ArenaHashMap {
+  static_assert(std::is_trivially_destructible_v<K> &&
+                    std::is_trivially_destructible_v<V>,
+                "ArenaHashMap never destroys its keys and values");
+
+public:
+  /**
+   * @brief A key and its value.
+   */
+  struct Slot {
+    K key;   ///< The key.
+    V value; ///< The value.
+  };
+
+  /**
+   * @brief Deleted default constructor.
+   */
+  ArenaHashMap() = delete;
+
+  /**
+   * @brief Constructs an empty map, no memory is allocated until the first
+   * insertion.
+   * @param arena The arena the table is allocated from.
+   */
+  explicit ArenaHashMap(BasicLinearArena<Stats> &arena) : arena_(&arena) {}
+
+  ArenaHashMap(const ArenaHashMap &) = delete;
+  ArenaHashMap &operator=(const ArenaHashMap &) = delete;
+
+  /**
+   * @brief Makes room for atleast `count` keys without growing.
+   * @param count The number of keys to make room for.
+   * @return false if out of memory.
+   */
+  bool reserve(size_t count) {
+    size_t capacity = group_size;
+    while (capacity / 8 * 7 < count)
+      capacity *= 2;
+    return capacity <= capacity_ || rehash(capacity);
+  }
+
+  /**
+   * @brief Looks up a key.
+   * @param key The key to look up.
+   * @return A pointer to its value, or nullptr if the key isn't in the map.
+   */
+  V *find(const K &key) { return find(key, Hash{}(key)); }
+  const V *find(const K &key) const { return find(key, Hash{}(key)); }
+
+  /**
+   * @brief Looks up a key whose hash was already computed.
+   * @param key The key to look up.
+   * @param hash `Hash{}(key)`.
+   * @return A pointer to its value, or nullptr if the key isn't in the map.
+   */
+  V *find(const K &key, size_t hash) {
+    size_t index = find_index(key, mix(hash));
+    return index == npos ? nullptr : &slots_[index].value;
+  }
+  const V *find(const K &key, size_t hash) const {
+    size_t index = find_index(key, mix(hash));
+    return index == npos ? nullptr : &slots_[index].value;
+  }
+
+  /**
+   * @brief Checks whether a key is in the map.
+   */
+  bool contains(const K &key) const { return find(key) != nullptr; }
+
+  /**
+   * @brief Inserts a key if it isn't in the map yet.
+   * @tparam Args The types of the arguments forwarded to the constructor of
+   * the value.
+   * @param key The key to insert.
+   * @param args Arguments to be forwarded to the constructor of `V`.
+   * @return A pointer to the value of `key` and whether it was inserted. The
+   * pointer is null if out of memory.
+   *
+   * Pointers to values stay valid until the map grows.
+   */
+  template <typename... Args>
+  std::pair<V *, bool> try_emplace(const K &key, Args &&...args) {
+    return try_emplace_hashed(Hash{}(key), key, std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Inserts a key whose hash was already computed if it isn't in the
+   * map yet.
+   * @param hash `Hash{}(key)`.
+   *
+   * See `try_emplace`.
+   */
+  template <typename... Args>
+  std::pair<V *, bool> try_emplace_hashed(size_t hash, const K &key,
+                                          Args &&...args) {
+    hash = mix(hash);
+    size_t index = find_index(key, hash);
+    if (index != npos)
+      return {&slots_[index].value, false};
+    if ((size_ + tombstones_ + 1) > capacity_ / 8 * 7 &&
+        !rehash(2 * (size_ + 1) > capacity_ / 8 * 7 ? 2 * capacity_
+                                                    : capacity_))
+      return {nullptr, false};
+    index = find_free(hash);
+    if (ctrl_[index] == ctrl_deleted)
+      --tombstones_;
+    ctrl_[index] = h2(hash);
+    ++size_;
+    new (&slots_[index]) Slot{key, V(std::forward<Args>(args)...)};
+    return {&slots_[index].value, true};
+  }
+
+  /**
+   * @brief Inserts a key with a value if it isn't in the map yet.
+   * @return A pointer to the value of `key` and whether it was inserted. The
+   * pointer is null if out of memory.
+   */
+  std::pair<V *, bool> insert(const K &key, const V &value) {
+    return try_emplace(key, value);
+  }
+
+  /**
+   * @brief Removes a key by leaving a tombstone in its slot.
+   * @return false if the key wasn't in the map.
+   */
+  bool erase(const K &key) {
+    size_t index = find_index(key, mix(Hash{}(key)));
+    if (index == npos)
+      return false;
+    ctrl_[index] = ctrl_deleted;
+    --size_;
+    ++tombstones_;
+    return true;
+  }
+
+  /**
+   * @brief Removes every key, the table is kept.
+   */
+  void clear() {
+    if (ctrl_)
+      memset(ctrl_, ctrl_empty, capacity_);
+    size_ = tombstones_ = 0;
+  }
+
+  /**
+   * @brief Calls `f(key, value)` for every entry, in no particular order.
+   */
+  template <typename F> void for_each(F &&f) {
+    for (size_t i = 0; i < capacity_; ++i)
+      if (ctrl_[i] >= 0)
+        f(slots_[i].key, slots_[i].value);
+  }
+
+  /**
+   * @brief Returns the number of keys.
+   */
+  size_t size() const { return size_; }
+
+  /**
+   * @brief Checks whether the map has no keys.
+   */
+  bool empty() const { return size_ == 0; }
+
+  /**
+   * @brief Returns the number of slots of the table.
+   */
+  size_t capacity() const { return capacity_; }
+
+private:
+  static constexpr size_t group_size = 16;
+  static constexpr size_t npos = ~size_t{0};
+  static constexpr int8_t ctrl_empty = -128;
+  static constexpr int8_t ctrl_deleted = -2;
+
+  /**
+   * @brief 16 control bytes compared at once.
+   */
+  struct Group {
+#ifdef __SSE2__
+    explicit Group(const int8_t *ctrl)
+        : ctrl(_mm_load_si128(reinterpret_cast<const __m128i *>(ctrl))) {}
+
+    // Bit i set if control byte i is `byte`.
+    uint32_t match(int8_t byte) const {
+      return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(byte), ctrl));
+    }
+
+    // Bit i set if slot i is empty or deleted, both have the high bit set.
+    uint32_t match_free() const { return _mm_movemask_epi8(ctrl); }
+
+    __m128i ctrl; ///< The control bytes.
+#else
+    explicit Group(const int8_t *ctrl) : ctrl(ctrl) {}
+
+    uint32_t match(int8_t byte) const {
+      uint32_t mask = 0;
+      for (size_t i = 0; i < group_size; ++i)
+        mask |= uint32_t{ctrl[i] == byte} << i;
+      return mask;
+    }
+
+    uint32_t match_free() const {
+      uint32_t mask = 0;
+      for (size_t i = 0; i < group_size; ++i)
+        mask |= uint32_t{ctrl[i] < 0} << i;
+      return mask;
+    }
+
+    const int8_t *ctrl; ///< The control bytes.
+#endif
+  };
+
+  // std::hash is the identity for integers, spread every bit of it over the
+  // whole word before taking the group index and the 7 bit tag from it.
+  static size_t mix(size_t hash) {
+    __uint128_t product = __uint128_t{hash} * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(product) ^ static_cast<size_t>(product >> 64);
+  }
+
+  static int8_t h2(size_t hash) { return static_cast<int8_t>(hash >> 57); }
+
+  size_t find_index(const K &key, size_t hash) const {
+    if (!capacity_)
+      return npos;
+    size_t mask = capacity_ / group_size - 1;
+    size_t group = hash & mask;
+    for (size_t step = 1;; ++step) {
+      Group g(ctrl_ + group * group_size);
+      for (uint32_t m = g.match(h2(hash)); m; m &= m - 1) {
+        size_t index = group * group_size + std::countr_zero(m);
+        if (Eq{}(slots_[index].key, key))
+          return index;
+      }
+      // A key is never stored past a group that still has an empty slot.
+      if (g.match(ctrl_empty))
+        return npos;
+      group = (group + step) & mask;
+    }
+  }
+
+  // The first empty or deleted slot on the probe sequence of `hash`.
+  size_t find_free(size_t hash) const {
+    size_t mask = capacity_ / group_size - 1;
+    size_t group = hash & mask;
+    for (size_t step = 1;; ++step) {
+      if (uint32_t m = Group(ctrl_ + group * group_size).match_free())
+        return group * group_size + std::countr_zero(m);
+      group = (group + step) & mask;
+    }
+  }
+
+  // Moves every key to a new table of `capacity` slots, dropping tombstones.
+  bool rehash(size_t capacity) {
+    if (capacity < group_size)
+      capacity = group_size;
+    // Control bytes and slots share one block, so a table that doesn't fit
+    // leaves nothing behind in the arena. `capacity` is a multiple of 16,
+    // the slots only need rounding for alignments above that.
+    constexpr size_t alignment = alignof(Slot) > alignof(std::max_align_t)
+                                     ? alignof(Slot)
+                                     : alignof(std::max_align_t);
+    size_t slots_offset = (capacity + alignof(Slot) - 1) & ~(alignof(Slot) - 1);
+    if (capacity > (~size_t{0} - slots_offset) / sizeof(Slot))
+      return false;
+    char *block = static_cast<char *>(arena_->alloc_aligned(
+        slots_offset + sizeof(Slot) * capacity, alignment));
+    if (!block)
+      return false;
+    int8_t *ctrl = reinterpret_cast<int8_t *>(block);
+    Slot *slots = reinterpret_cast<Slot *>(block + slots_offset);
+    memset(ctrl, ctrl_empty, capacity);
+    int8_t *old_ctrl = std::exchange(ctrl_, ctrl);
+    Slot *old_slots = std::exchange(slots_, slots);
+    size_t old_capacity = std::exchange(capacity_, capacity);
+    for (size_t i = 0; i < old_capacity; ++i) {
+      if (old_ctrl[i] < 0)
+        continue;
+      size_t hash = mix(Hash{}(old_slots[i].key));
+      size_t index = find_free(hash);
+      ctrl_[index] = h2(hash);
+      new (&slots_[index]) Slot(std::move(old_slots[i]));
+    }
+    tombstones_ = 0;
+    return true;
+  }
+
+  int8_t *ctrl_ = nullptr; ///< One control byte per slot.
+  Slot *slots_ = nullptr;  ///< The keys and values.
+  size_t capacity_ = 0;    ///< Number of slots, a power of two.
+  size_t size_ = 0;        ///< Number of keys.
+  size_t tombstones_ = 0;  ///< Number of deleted slots.
+  BasicLinearArena<Stats> *arena_; ///< The arena the table comes from.
+};
+
+} // namespace Spektral::Arenas
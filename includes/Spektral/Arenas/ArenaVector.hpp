@@ -0,0 +1,274 @@
+#pragma once
+#include "LinearArena.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Spektral::Arenas {
+
+/**
+ * @class ArenaVector
+ * @brief A growable array that lives entirely in a `LinearArena`.
+ *
+ * While the buffer is the most recent allocation of the arena it grows and
+ * shrinks in place by just moving the arena's offset. Otherwise it doubles
+ * into a new block of the arena, the old block is only given back on
+ * `reset()`. `shrink_to_fit()` gives the unused tail of the buffer back to
+ * the arena.
+ *
+ * The vector is 24 bytes: a pointer, 32 bit size and capacity, and the
+ * arena. It has no destructor at all when T is trivially destructible.
+ *
+ * Operations that need memory report failure instead of throwing: `reserve`,
+ * `resize` and `push_back` return false and `emplace_back` returns nullptr
+ * when the arena is full, the vector is left unchanged then.
+ *
+ * @tparam T The type of the elements.
+ * @tparam Stats The stats policy of the arena, `NoStats` by default.
+ */
+template <typename T, class Stats = NoStats> class ArenaVector {
+public:
+  /**
+   * @brief Deleted default constructor.
+   */
+  ArenaVector() = delete;
+
+  /**
+   * @brief Constructs an empty vector, no memory is allocated.
+   * @param arena The arena the elements are allocated from.
+   */
+  explicit ArenaVector(BasicLinearArena<Stats> &arena) : arena_(&arena) {}
+
+  ArenaVector(const ArenaVector &) = delete;
+  ArenaVector &operator=(const ArenaVector &) = delete;
+
+  /**
+   * @brief Takes over the elements of `other`, which is left empty.
+   */
+  ArenaVector(ArenaVector &&other) noexcept
+      : data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0)),
+        capacity_(std::exchange(other.capacity_, 0)), arena_(other.arena_) {}
+
+  /**
+   * @brief Destroys the elements and takes over the ones of `other`, which is
+   * left empty.
+   */
+  ArenaVector &operator=(ArenaVector &&other) noexcept {
+    if (this != &other) {
+      clear();
+      data_ = std::exchange(other.data_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+      capacity_ = std::exchange(other.capacity_, 0);
+      arena_ = other.arena_;
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Trivially destructible elements need no destructor.
+   */
+  ~ArenaVector()
+    requires std::is_trivially_destructible_v<T>
+  = default;
+
+  /**
+   * @brief Destroys the elements. The memory stays in the arena.
+   */
+  ~ArenaVector() { clear(); }
+
+  /**
+   * @brief Makes room for atleast `capacity` elements.
+   * @param capacity The number of elements to make room for.
+   * @return false if out of memory.
+   */
+  bool reserve(size_t capacity) {
+    return capacity <= capacity_ || grow(capacity);
+  }
+
+  /**
+   * @brief Changes the number of elements, new elements are
+   * value-initialized.
+   * @param size The new number of elements.
+   * @return false if out of memory.
+   */
+  bool resize(size_t size) {
+    if (size > capacity_ && !grow(size))
+      return false;
+    for (; size_ < size; ++size_)
+      new (data_ + size_) T();
+    while (size_ > size)
+      data_[--size_].~T();
+    return true;
+  }
+
+  /**
+   * @brief Constructs a new element at the end of the vector.
+   * @tparam Args The types of the arguments forwarded to the constructor.
+   * @param args Arguments to be forwarded to the constructor of `T`.
+   * @return A pointer to the new element, or nullptr if out of memory.
+   */
+  template <typename... Args> T *emplace_back(Args &&...args) {
+    if (size_ < capacity_)
+      return new (data_ + size_++) T(std::forward<Args>(args)...);
+    size_t capacity = next_capacity();
+    if (!capacity)
+      return nullptr;
+    if (is_last()) {
+      if (!grow_in_place(capacity))
+        return nullptr;
+      return new (data_ + size_++) T(std::forward<Args>(args)...);
+    }
+    // Relocating: construct the new element first, `args` may refer to one of
+    // the old elements.
+    T *grown = arena_->template alloc<T>(capacity);
+    if (!grown)
+      return nullptr;
+    T *ptr = new (grown + size_) T(std::forward<Args>(args)...);
+    relocate(grown);
+    capacity_ = capacity;
+    ++size_;
+    return ptr;
+  }
+
+  /**
+   * @brief Copies an element to the end of the vector.
+   * @return false if out of memory.
+   */
+  bool push_back(const T &value) { return emplace_back(value); }
+
+  /**
+   * @brief Moves an element to the end of the vector.
+   * @return false if out of memory.
+   */
+  bool push_back(T &&value) { return emplace_back(std::move(value)); }
+
+  /**
+   * @brief Destroys the last element.
+   */
+  void pop_back() { data_[--size_].~T(); }
+
+  /**
+   * @brief Destroys every element, the capacity is kept.
+   */
+  void clear() {
+    if constexpr (!std::is_trivially_destructible_v<T>)
+      while (size_)
+        data_[--size_].~T();
+    size_ = 0;
+  }
+
+  /**
+   * @brief Gives the unused capacity back to the arena if the buffer is its
+   * most recent allocation, does nothing otherwise.
+   */
+  void shrink_to_fit() {
+    if (data_ && arena_->is_last(data_, sizeof(T) * capacity_)) {
+      arena_->extend(data_, sizeof(T) * capacity_, sizeof(T) * size_);
+      capacity_ = size_;
+    }
+  }
+
+  T &operator[](size_t i) { return data_[i]; }
+  const T &operator[](size_t i) const { return data_[i]; }
+  T &front() { return data_[0]; }
+  const T &front() const { return data_[0]; }
+  T &back() { return data_[size_ - 1]; }
+  const T &back() const { return data_[size_ - 1]; }
+  T *begin() { return data_; }
+  const T *begin() const { return data_; }
+  T *end() { return data_ + size_; }
+  const T *end() const { return data_ + size_; }
+
+  /**
+   * @brief Returns a pointer to the first element.
+   */
+  T *data() { return data_; }
+  const T *data() const { return data_; }
+
+  /**
+   * @brief Returns the number of elements.
+   */
+  size_t size() const { return size_; }
+
+  /**
+   * @brief Returns the number of elements the buffer can hold.
+   */
+  size_t capacity() const { return capacity_; }
+
+  /**
+   * @brief Checks whether the vector has no elements.
+   */
+  bool empty() const { return size_ == 0; }
+
+  /**
+   * @brief Returns the arena the elements are allocated from.
+   */
+  BasicLinearArena<Stats> &arena() const { return *arena_; }
+
+private:
+  static constexpr size_t max_capacity = std::numeric_limits<uint32_t>::max();
+
+  // Doubles the capacity, 0 if that doesn't fit the 32 bit capacity.
+  size_t next_capacity() const {
+    size_t capacity = capacity_ ? 2 * size_t{capacity_} : 4;
+    return capacity > max_capacity ? 0 : capacity;
+  }
+
+  // Grows the buffer to atleast `capacity` elements.
+  bool grow(size_t capacity) {
+    size_t doubled = next_capacity();
+    if (capacity < doubled)
+      capacity = doubled;
+    if (capacity > max_capacity)
+      return false;
+    if (is_last())
+      return grow_in_place(capacity);
+    T *grown = arena_->template alloc<T>(capacity);
+    if (!grown)
+      return false;
+    relocate(grown);
+    capacity_ = capacity;
+    return true;
+  }
+
+  // Whether the buffer is the most recent allocation of the arena.
+  bool is_last() const {
+    return data_ && arena_->is_last(data_, sizeof(T) * capacity_);
+  }
+
+  // Grows the buffer without moving it, only possible while `is_last()`. If
+  // that fails the arena has no room left past the buffer, so a new block
+  // wouldn't fit either and isn't tried.
+  bool grow_in_place(size_t capacity) {
+    if (!arena_->extend(data_, sizeof(T) * capacity_, sizeof(T) * capacity))
+      return false;
+    capacity_ = capacity;
+    return true;
+  }
+
+  // Moves every element to `grown`.
+  void relocate(T *grown) {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      if (size_)
+        memcpy(grown, data_, sizeof(T) * size_);
+    } else {
+      for (size_t i = 0; i < size_; ++i) {
+        new (grown + i) T(std::move_if_noexcept(data_[i]));
+        data_[i].~T();
+      }
+    }
+    data_ = grown;
+  }
+
+  T *data_ = nullptr;     ///< The elements.
+  uint32_t size_ = 0;     ///< Number of elements.
+  uint32_t capacity_ = 0; ///< Number of elements the buffer can hold.
+  BasicLinearArena<Stats> *arena_; ///< The arena the buffer comes from.
+};
+
+} // namespace Spektral::Arenas
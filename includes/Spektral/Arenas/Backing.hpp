@@ -0,0 +1,214 @@
+#pragma once
+#include "utils.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utility>
+
+namespace Spektral::Arenas {
+
+/**
+ * @brief Where the memory of an arena comes from.
+ */
+enum class Backing {
+  Heap,          ///< One malloc'd block, committed up front.
+  VirtualMemory, ///< A reserved virtual range, committed as it gets used.
+  HugePages      ///< A mapping backed by 2MB pages, committed up front.
+};
+
+/**
+ * @brief Which kind of huge pages a `Backing::HugePages` region actually got.
+ */
+enum class HugePageMode {
+  None,       ///< Regular pages, neither kind of huge page was available.
+  Explicit,   ///< Pages from the hugetlbfs pool through `MAP_HUGETLB`.
+  Transparent ///< A 2MB aligned mapping advised with `MADV_HUGEPAGE`, with
+              ///< transparent huge pages enabled on the system.
+};
+
+/**
+ * @class Region
+ * @brief An owned, contiguous block of memory an arena allocates from.
+ *
+ * With `Backing::Heap` the whole block is malloc'd and usable right away.
+ * With `Backing::VirtualMemory` the range is only reserved with
+ * `mmap(PROT_NONE)` and `MAP_NORESERVE`, and pages are made accessible by
+ * `commit()` as the arena grows into them. The range never moves, so
+ * pointers into it stay valid, and RSS tracks what was actually touched.
+ * With `Backing::HugePages` the region first tries explicit huge pages and
+ * falls back to transparent huge pages on a 2MB aligned mapping,
+ * `huge_pages()` reports which one it got.
+ */
+class Region {
+public:
+  /**
+   * @brief Deleted default constructor.
+   */
+  Region() = delete;
+
+  /**
+   * @brief Allocates or reserves a region of atleast `size` bytes.
+   * @param size The size of the region in bytes.
+   * @param backing Where the memory comes from.
+   *
+   * Throws std::bad_alloc if allocation fails.
+   *
+   * @note Heap regions are sized with `optimal_alloc(size)`, huge page
+   * regions with `optimal_alloc(size, true)` and virtual memory regions are
+   * rounded up to a multiple of the page size.
+   */
+  Region(size_t size, Backing backing) : backing_(backing) {
+    if (backing_ == Backing::Heap) {
+      size_ = optimal_alloc(size);
+      data_ = static_cast<char *>(malloc(size_));
+      if (!data_)
+        throw std::bad_alloc();
+      committed_ = size_;
+      return;
+    }
+    if (backing_ == Backing::HugePages) {
+      map_huge_pages(size);
+      return;
+    }
+    size_t page_size = sysconf(_SC_PAGE_SIZE);
+    size_ = (size + page_size - 1) / page_size * page_size;
+    void *ptr = mmap(nullptr, size_, PROT_NONE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (ptr == MAP_FAILED)
+      throw std::bad_alloc();
+    data_ = static_cast<char *>(ptr);
+  }
+
+  Region(const Region &) = delete;
+  Region &operator=(const Region &) = delete;
+
+  /**
+   * @brief Frees or unmaps the region.
+   */
+  ~Region() {
+    if (backing_ == Backing::Heap)
+      free(data_);
+    else
+      munmap(data_, size_);
+  }
+
+  /**
+   * @brief Makes sure the first `end` bytes of the region are usable.
+   * @param end The offset up to which memory has to be committed.
+   * @return false if `end` is past the end of the region or the pages could
+   * not be committed.
+   *
+   * Commits in steps of atleast `commit_granularity` bytes so that a bump
+   * allocator doesn't need a syscall for every page.
+   */
+  bool commit(size_t end) {
+    if (end <= committed_)
+      return true;
+    if (end > size_)
+      return false;
+    size_t target = (end + commit_granularity - 1) & ~(commit_granularity - 1);
+    if (target > size_)
+      target = size_;
+    if (mprotect(data_ + committed_, target - committed_,
+                 PROT_READ | PROT_WRITE))
+      return false;
+    committed_ = target;
+    return true;
+  }
+
+  /**
+   * @brief Returns a pointer to the start of the region.
+   */
+  char *data() const { return data_; }
+
+  /**
+   * @brief Returns the size of the region in bytes.
+   */
+  size_t size() const { return size_; }
+
+  /**
+   * @brief Returns how many bytes from the start of the region are usable.
+   */
+  size_t committed() const { return committed_; }
+
+  /**
+   * @brief Returns where the memory of the region comes from.
+   */
+  Backing backing() const { return backing_; }
+
+  /**
+   * @brief Returns which kind of huge pages backs the region, always
+   * `HugePageMode::None` unless it was created with `Backing::HugePages`.
+   *
+   * `Transparent` is only reported when the kernel's transparent huge page
+   * mode is `always` or `madvise`. Even then the kernel hands out huge pages
+   * on a best effort basis, `AnonHugePages` in `/proc/self/smaps` tells how
+   * many the region really got.
+   */
+  HugePageMode huge_pages() const { return huge_pages_; }
+
+  /**
+   * @brief Minimum number of bytes committed at once, a multiple of any
+   * common page size.
+   */
+  static constexpr size_t commit_granularity = 64 << 10;
+
+private:
+  void map_huge_pages(size_t size) {
+    size_ = optimal_alloc(size, true);
+    committed_ = size_;
+#ifdef MAP_HUGETLB
+    void *ptr = mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED) {
+      data_ = static_cast<char *>(ptr);
+      huge_pages_ = HugePageMode::Explicit;
+      return;
+    }
+#endif
+    // Over-map by one huge page, then trim both ends so the region starts on
+    // a huge page boundary and the kernel can actually use huge pages for it.
+    size_t mapped = size_ + huge_page_size;
+    void *raw = mmap(nullptr, mapped, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+      throw std::bad_alloc();
+    char *base = static_cast<char *>(raw);
+    size_t head = -reinterpret_cast<uintptr_t>(base) & (huge_page_size - 1);
+    if (head)
+      munmap(base, head);
+    munmap(base + head + size_, huge_page_size - head);
+    data_ = base + head;
+#ifdef MADV_HUGEPAGE
+    // madvise succeeds even when THP is disabled, so check the system mode.
+    if (!madvise(data_, size_, MADV_HUGEPAGE) && transparent_huge_pages())
+      huge_pages_ = HugePageMode::Transparent;
+#endif
+  }
+
+  // Whether the kernel gives transparent huge pages to advised mappings, the
+  // current mode is the bracketed one, e.g. "always [madvise] never".
+  static bool transparent_huge_pages() {
+    FILE *file = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+    if (!file)
+      return false;
+    char mode[64] = {};
+    bool enabled = fgets(mode, sizeof(mode), file) &&
+                   (strstr(mode, "[always]") || strstr(mode, "[madvise]"));
+    fclose(file);
+    return enabled;
+  }
+
+  char *data_ = nullptr; ///< Start of the region.
+  size_t size_;          ///< Size of the region.
+  size_t committed_ = 0; ///< Usable bytes from the start of the region.
+  Backing backing_;      ///< Where the memory comes from.
+  HugePageMode huge_pages_ = HugePageMode::None; ///< Huge pages obtained.
+};
+
+} // namespace Spektral::Arenas
@@ -0,0 +1,171 @@
+#pragma once
+#include "utils.hpp"
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+namespace Spektral::Arenas {
+
+/**
+ * @class BlockArena
+ * @brief A fixed-size block pool with O(1) allocation and deallocation.
+ *
+ * Every allocation hands out one block of the same size. Freed blocks are kept
+ * in an intrusive free list threaded through the blocks themselves, so there
+ * is no per-block bookkeeping. Blocks that were never handed out are taken
+ * from a bump offset, which keeps both construction and `reset()` O(1).
+ *
+ * @note Only use with trivially destroyable types as destructors ARE NOT called
+ * when the arena goes out of scope. Use `destroy` to destroy and free a single
+ * object.
+ */
+class BlockArena {
+public:
+  /**
+   * @brief Deleted default constructor.
+   */
+  BlockArena() = delete;
+
+  /**
+   * @brief Constructs a BlockArena holding atleast `block_count` blocks of
+   * `block_size` bytes.
+   * @param block_size The size of each block in bytes.
+   * @param block_count The minimum number of blocks in the pool.
+   *
+   * Block sizes are rounded up to a multiple of `alignof(std::max_align_t)`,
+   * so every block is suitably aligned for any type. Throws std::bad_alloc if
+   * allocation fails.
+   *
+   * @note Actual allocated size is based on `optimal_alloc(size)`, any extra
+   * space is turned into extra blocks.
+   */
+  BlockArena(size_t block_size, size_t block_count)
+      : block_size_(round_block(block_size)) {
+    size_ = optimal_alloc(block_size_ * block_count);
+    size_ -= size_ % block_size_;
+    data = static_cast<char *>(malloc(size_));
+    if (!data)
+      throw std::bad_alloc();
+  }
+
+  BlockArena(const BlockArena &) = delete;
+  BlockArena &operator=(const BlockArena &) = delete;
+
+  /**
+   * @brief Destructor that frees the allocated memory.
+   */
+  ~BlockArena() { ::free(data); }
+
+  /**
+   * @brief Allocates a single block from the pool.
+   * @return A pointer to the block, or nullptr if every block is in use.
+   */
+  inline void *alloc() {
+    if (free_list_) {
+      FreeBlock *block = free_list_;
+      free_list_ = block->next;
+      return block;
+    }
+    if (current_offset_ == size_)
+      return nullptr;
+    void *ptr = data + current_offset_;
+    current_offset_ += block_size_;
+    return ptr;
+  }
+
+  /**
+   * @brief Allocates a block for an object of type T.
+   * @tparam T The type of object to allocate.
+   * @return A pointer to the block, or nullptr if every block is in use or T
+   * doesn't fit in a block.
+   */
+  template <typename T> T *alloc() {
+    if (sizeof(T) > block_size_)
+      return nullptr;
+    return static_cast<T *>(alloc());
+  }
+
+  /**
+   * @brief Returns a block to the pool.
+   * @param ptr A pointer previously returned by `alloc` on this arena, or
+   * nullptr.
+   */
+  inline void free(void *ptr) {
+    if (!ptr)
+      return;
+    FreeBlock *block = static_cast<FreeBlock *>(ptr);
+    block->next = free_list_;
+    free_list_ = block;
+  }
+
+  /**
+   * @brief Creates and initializes a new object of type `T` in a block.
+   * @tparam T The type of the object to be constructed.
+   * @tparam Args The types of the arguments forwarded to the constructor.
+   * @param args Arguments to be forwarded to the constructor of `T`.
+   * @return A pointer to the new object, or nullptr if out of blocks.
+   */
+  template <typename T, typename... Args> T *make(Args &&...args) {
+    T *ptr = alloc<T>();
+    return ptr ? new (ptr) T(std::forward<Args>(args)...) : nullptr;
+  }
+
+  /**
+   * @brief Destroys an object created by `make` and returns its block to the
+   * pool.
+   * @tparam T The type of the object.
+   * @param ptr The object to destroy, or nullptr.
+   */
+  template <typename T> void destroy(T *ptr) {
+    if (!ptr)
+      return;
+    ptr->~T();
+    free(ptr);
+  }
+
+  /**
+   * @brief Resets the memory arena.
+   *
+   * Makes every block available again, whether it was freed or not.
+   *
+   * Destructors won't be called.
+   */
+  void reset() {
+    free_list_ = nullptr;
+    current_offset_ = 0;
+  }
+
+  /**
+   * @brief Returns the size of a single block in bytes.
+   */
+  size_t block_size() const { return block_size_; }
+
+  /**
+   * @brief Returns the total number of blocks in the pool.
+   */
+  size_t block_count() const { return size_ / block_size_; }
+
+private:
+  /**
+   * @brief Link stored inside every free block.
+   */
+  struct FreeBlock {
+    FreeBlock *next; ///< The next free block.
+  };
+
+  static size_t round_block(size_t size) {
+    constexpr size_t alignment = alignof(std::max_align_t);
+    if (size < sizeof(FreeBlock))
+      size = sizeof(FreeBlock);
+    return (size + alignment - 1) & ~(alignment - 1);
+  }
+
+  size_t block_size_;              ///< The size of every block.
+  size_t size_;                    ///< The total size of the memory arena.
+  size_t current_offset_ = 0;      ///< End of the blocks handed out so far.
+  FreeBlock *free_list_ = nullptr; ///< Head of the free list.
+  char *data = nullptr;            ///< Pointer to the allocated memory block.
+};
+
+} // namespace Spektral::Arenas
@@ -0,0 +1,270 @@
+#pragma once
+#include "Backing.hpp"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace Spektral::Arenas {
+
+/**
+ * @class BuddyArena
+ * @brief A buddy system allocator over one contiguous region.
+ *
+ * Hands out power-of-two blocks between `min_block` and the size of the whole
+ * region, and any block can be freed at any time. Blocks are split in halves
+ * on allocation and merged back with their buddy on free, both in O(log n).
+ *
+ * There are no per-block headers. The arena keeps two bitmaps over the
+ * implicit binary tree of blocks: one bit per internal node telling whether
+ * it is split, and one bit per pair of buddies holding `free(a) XOR free(b)`.
+ * Free blocks of every size are linked through their own memory.
+ *
+ * @note Blocks are aligned to their size relative to the start of the region,
+ * use `Backing::VirtualMemory` if they need to be page aligned in memory.
+ * Destructors ARE NOT called when the arena goes out of scope. Use `destroy`
+ * to destroy and free a single object.
+ */
+class BuddyArena {
+public:
+  /**
+   * @brief Deleted default constructor.
+   */
+  BuddyArena() = delete;
+
+  /**
+   * @brief Constructs a BuddyArena.
+   * @param size The size of the region in bytes, rounded up to a power of
+   * two.
+   * @param min_block The size of the smallest block, rounded up to a power of
+   * two. 4096 by default.
+   * @param backing Where the memory comes from. `Backing::Heap` by default.
+   *
+   * Throws std::bad_alloc if allocation fails.
+   */
+  explicit BuddyArena(size_t size, size_t min_block = 4096,
+                      Backing backing = Backing::Heap)
+      : min_block_(std::bit_ceil(min_block < sizeof(FreeNode)
+                                     ? sizeof(FreeNode)
+                                     : min_block)),
+        size_(std::bit_ceil(size < min_block_ ? min_block_ : size)),
+        region_(size_, backing) {
+    if (!region_.commit(size_))
+      throw std::bad_alloc();
+    data = region_.data();
+    levels_ = std::countr_zero(size_) - std::countr_zero(min_block_) + 1;
+    size_t internal = (size_t{1} << (levels_ - 1)) - 1;
+    split_.resize((internal + 63) / 64);
+    pairs_.resize((internal + 63) / 64);
+    heads_.resize(levels_);
+    reset();
+  }
+
+  BuddyArena(const BuddyArena &) = delete;
+  BuddyArena &operator=(const BuddyArena &) = delete;
+
+  /**
+   * @brief Allocates a block of atleast `size` bytes.
+   * @param size The number of bytes to allocate.
+   * @return A pointer to the block, or nullptr if no block is big enough.
+   */
+  void *alloc(size_t size) {
+    if (size > size_)
+      return nullptr;
+    size_t block = std::bit_ceil(size < min_block_ ? min_block_ : size);
+    size_t level = std::countr_zero(size_) - std::countr_zero(block);
+    // The smallest free block that is big enough lives on the deepest
+    // non-empty level at or above the target one.
+    uint64_t candidates = nonempty_ & ((uint64_t{2} << level) - 1);
+    if (!candidates)
+      return nullptr;
+    size_t current = std::bit_width(candidates) - 1;
+    FreeNode *node = pop(current);
+    size_t index = node_index(node, current);
+    if (current)
+      toggle(pairs_, parent(index));
+    // Split down to the right size, keeping the left half and freeing the
+    // right one every time.
+    for (; current < level; ++current) {
+      set(split_, index);
+      index = 2 * index + 1;
+      toggle(pairs_, parent(index));
+      push(reinterpret_cast<FreeNode *>(reinterpret_cast<char *>(node) +
+                                        (size_ >> (current + 1))),
+           current + 1);
+    }
+    return node;
+  }
+
+  /**
+   * @brief Allocates memory for an array of objects of type T.
+   * @tparam T The type of object to allocate.
+   * @param count The number of objects to allocate.
+   * @return A pointer to the allocated memory, or nullptr if no block is big
+   * enough.
+   */
+  template <typename T> T *alloc(size_t count) {
+    if (count > size_ / (sizeof(T) ? sizeof(T) : 1))
+      return nullptr;
+    return static_cast<T *>(alloc(sizeof(T) * count));
+  }
+
+  /**
+   * @brief Frees a block and merges it with its buddy as long as possible.
+   * @param ptr A pointer previously returned by `alloc` on this arena, or
+   * nullptr.
+   */
+  void free(void *ptr) {
+    if (!ptr)
+      return;
+    size_t offset = static_cast<char *>(ptr) - data;
+    // Walk down the split nodes to find the block and its level.
+    size_t index = 0;
+    size_t level = 0;
+    while (level + 1 < levels_ && test(split_, index)) {
+      ++level;
+      index = 2 * index + 1 + ((offset >> (levels_shift() - level)) & 1);
+    }
+    assert(offset % (size_ >> level) == 0 && "not the start of a block");
+    for (; level; --level) {
+      size_t up = parent(index);
+      // A zero after the toggle means the buddy is free too
+      if (toggle(pairs_, up))
+        break;
+      remove(node_at(buddy(index), level), level);
+      clear(split_, up);
+      index = up;
+    }
+    push(node_at(index, level), level);
+  }
+
+  /**
+   * @brief Creates and initializes a new object of type `T` inside the arena.
+   * @tparam T The type of the object to be constructed.
+   * @tparam Args The types of the arguments forwarded to the constructor.
+   * @param args Arguments to be forwarded to the constructor of `T`.
+   * @return A pointer to the new object, or nullptr if out of memory.
+   */
+  template <typename T, typename... Args> T *make(Args &&...args) {
+    T *ptr = alloc<T>(1);
+    return ptr ? new (ptr) T(std::forward<Args>(args)...) : nullptr;
+  }
+
+  /**
+   * @brief Destroys an object created by `make` and frees its block.
+   * @tparam T The type of the object.
+   * @param ptr The object to destroy, or nullptr.
+   */
+  template <typename T> void destroy(T *ptr) {
+    if (!ptr)
+      return;
+    ptr->~T();
+    free(ptr);
+  }
+
+  /**
+   * @brief Resets the memory arena.
+   *
+   * Makes the whole region one free block again.
+   *
+   * Destructors won't be called.
+   */
+  void reset() {
+    std::fill(split_.begin(), split_.end(), 0);
+    std::fill(pairs_.begin(), pairs_.end(), 0);
+    std::fill(heads_.begin(), heads_.end(), nullptr);
+    nonempty_ = 0;
+    push(reinterpret_cast<FreeNode *>(data), 0);
+  }
+
+  /**
+   * @brief Returns the size of the whole region in bytes.
+   */
+  size_t capacity() const { return size_; }
+
+  /**
+   * @brief Returns the size of the smallest block in bytes.
+   */
+  size_t min_block() const { return min_block_; }
+
+private:
+  /**
+   * @brief Links stored inside every free block.
+   */
+  struct FreeNode {
+    FreeNode *prev; ///< The previous free block of the same size.
+    FreeNode *next; ///< The next free block of the same size.
+  };
+
+  static size_t parent(size_t index) { return (index - 1) / 2; }
+  static size_t buddy(size_t index) { return ((index - 1) ^ 1) + 1; }
+
+  static bool test(const std::vector<uint64_t> &bits, size_t index) {
+    return bits[index / 64] >> (index % 64) & 1;
+  }
+  static void set(std::vector<uint64_t> &bits, size_t index) {
+    bits[index / 64] |= uint64_t{1} << (index % 64);
+  }
+  static void clear(std::vector<uint64_t> &bits, size_t index) {
+    bits[index / 64] &= ~(uint64_t{1} << (index % 64));
+  }
+  static bool toggle(std::vector<uint64_t> &bits, size_t index) {
+    return (bits[index / 64] ^= uint64_t{1} << (index % 64)) >> (index % 64) &
+           1;
+  }
+
+  size_t levels_shift() const { return std::countr_zero(size_); }
+
+  size_t node_index(const FreeNode *node, size_t level) const {
+    size_t offset = reinterpret_cast<const char *>(node) - data;
+    return (size_t{1} << level) - 1 + (offset >> (levels_shift() - level));
+  }
+
+  FreeNode *node_at(size_t index, size_t level) const {
+    size_t offset = (index + 1 - (size_t{1} << level))
+                    << (levels_shift() - level);
+    return reinterpret_cast<FreeNode *>(data + offset);
+  }
+
+  void push(FreeNode *node, size_t level) {
+    node->prev = nullptr;
+    node->next = heads_[level];
+    if (node->next)
+      node->next->prev = node;
+    heads_[level] = node;
+    nonempty_ |= uint64_t{1} << level;
+  }
+
+  void remove(FreeNode *node, size_t level) {
+    if (node->prev)
+      node->prev->next = node->next;
+    else
+      heads_[level] = node->next;
+    if (node->next)
+      node->next->prev = node->prev;
+    if (!heads_[level])
+      nonempty_ &= ~(uint64_t{1} << level);
+  }
+
+  FreeNode *pop(size_t level) {
+    FreeNode *node = heads_[level];
+    remove(node, level);
+    return node;
+  }
+
+  size_t min_block_;              ///< Size of the smallest block.
+  size_t size_;                   ///< Size of the whole region.
+  size_t levels_;                 ///< Number of block sizes.
+  Region region_;                 ///< Owner of the memory block.
+  char *data = nullptr;           ///< Pointer to the allocated memory block.
+  uint64_t nonempty_ = 0;         ///< Bit N set if level N has free blocks.
+  std::vector<FreeNode *> heads_; ///< Free list of every level.
+  std::vector<uint64_t> split_;   ///< Split bit of every internal node.
+  std::vector<uint64_t> pairs_;   ///< Free XOR bit of every buddy pair.
+};
+
+} // namespace Spektral::Arenas
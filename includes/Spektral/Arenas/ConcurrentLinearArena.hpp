@@ -0,0 +1,162 @@
+#pragma once
+#include "utils.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace Spektral::Arenas {
+
+/**
+ * @class ConcurrentLinearArena
+ * @brief A LinearArena that can be shared between threads without a lock.
+ *
+ * The allocation offset is an atomic, a plain allocation is a single
+ * `fetch_add` and an aligned allocation is a CAS loop that retries only if
+ * another thread moved the offset in between. Every successful allocation is
+ * guaranteed to lie entirely inside the arena and to not overlap with any
+ * other allocation.
+ *
+ * Quiescence rules for `reset()`: it must not run concurrently with any
+ * other member function, and no thread may still be using memory handed out
+ * before it. Callers have to establish that themselves (joining the workers,
+ * a barrier, the end of a fan-out, ...), the same synchronization also makes
+ * the reset visible to the threads that allocate afterwards.
+ *
+ * @note Only use with trivially destroyable types as destructors ARE NOT called
+ * when the arena goes out of scope.
+ */
+class ConcurrentLinearArena {
+public:
+  /**
+   * @brief Deleted default constructor.
+   */
+  ConcurrentLinearArena() = delete;
+
+  /**
+   * @brief Constructs a ConcurrentLinearArena with a given size.
+   * @param size The total size of the memory arena in bytes.
+   *
+   * Throws std::bad_alloc if allocation fails.
+   *
+   * @note Actual allocated size is based on `optimal_alloc(size)`
+   */
+  explicit ConcurrentLinearArena(size_t size) {
+    size_ = optimal_alloc(size);
+    data = static_cast<char *>(malloc(size_));
+    if (!data)
+      throw std::bad_alloc();
+  }
+
+  ConcurrentLinearArena(const ConcurrentLinearArena &) = delete;
+  ConcurrentLinearArena &operator=(const ConcurrentLinearArena &) = delete;
+
+  /**
+   * @brief Destructor that frees the allocated memory.
+   */
+  ~ConcurrentLinearArena() { free(data); }
+
+  /**
+   * @brief Allocates a block of memory from the arena. Thread safe.
+   * @param size The number of bytes to allocate.
+   * @return A pointer to the allocated memory, or nullptr if out of memory.
+   *
+   * @note An allocation that loses a race for the last bytes still consumes
+   * the offset it claimed, so smaller ones that would have fit may fail too.
+   */
+  inline void *alloc(size_t size) {
+    // The offset only grows until `reset()`, a request that doesn't fit now
+    // never will. Checking first means only racing claims, each at most
+    // `size_`, can move the offset past the end, so it can't wrap around.
+    if (size > size_ ||
+        size > size_ - current_offset_.load(std::memory_order_relaxed))
+      return nullptr;
+    size_t offset = current_offset_.fetch_add(size, std::memory_order_relaxed);
+    if (offset > size_ || size > size_ - offset)
+      return nullptr;
+    return data + offset;
+  }
+
+  /**
+   * @brief Allocates memory for an array of objects of type T. Thread safe.
+   * @tparam T The type of object to allocate.
+   * @param count The number of objects to allocate.
+   * @param align Define wether the block should be aligned. True by default.
+   * @return A pointer to the allocated memory, or nullptr if out of memory.
+   */
+  template <typename T> T *alloc(size_t count, bool align = true) {
+    if (count > size_ / sizeof(T))
+      return nullptr;
+    size_t required_size = sizeof(T) * count;
+    if (!align || alignof(T) == 1)
+      return static_cast<T *>(alloc(required_size));
+    size_t offset = current_offset_.load(std::memory_order_relaxed);
+    size_t padding;
+    do {
+      if (offset > size_)
+        return nullptr;
+      // Padding comes from the address, malloc only aligns the block to
+      // `alignof(std::max_align_t)`.
+      padding = -reinterpret_cast<uintptr_t>(data + offset) & (alignof(T) - 1);
+      if (padding > size_ - offset || required_size > size_ - offset - padding)
+        return nullptr;
+    } while (!current_offset_.compare_exchange_weak(
+        offset, offset + padding + required_size, std::memory_order_relaxed));
+    return reinterpret_cast<T *>(data + offset + padding);
+  }
+
+  /**
+   * @brief Allocates and zero-initializes memory for an array of objects of
+   * type T. Thread safe.
+   * @tparam T The type of object to allocate.
+   * @param blocks The number of objects to allocate.
+   * @return A pointer to the allocated memory, or nullptr if out of memory.
+   */
+  template <typename T> T *calloc(size_t blocks) {
+    T *ptr = alloc<T>(blocks);
+    if (ptr)
+      memset(ptr, 0, sizeof(T) * blocks);
+    return ptr;
+  }
+
+  /**
+   * @brief Creates and initializes a new object of type `T` inside the arena.
+   * Thread safe.
+   * @tparam T The type of the object to be constructed.
+   * @tparam Args The types of the arguments forwarded to the constructor.
+   * @param args Arguments to be forwarded to the constructor of `T`.
+   * @return A pointer to the new object, or nullptr if out of memory.
+   *
+   * @note Destructors won't get called.
+   */
+  template <typename T, typename... Args> T *make(Args &&...args) {
+    T *ptr = alloc<T>(1);
+    return ptr ? new (ptr) T(std::forward<Args>(args)...) : nullptr;
+  }
+
+  /**
+   * @brief Resets the memory arena.
+   *
+   * NOT thread safe, see the class documentation for the quiescence rules.
+   *
+   * Destructors won't be called.
+   */
+  void reset() { current_offset_.store(0, std::memory_order_relaxed); }
+
+  /**
+   * @brief Returns the total size of the memory arena in bytes.
+   */
+  size_t capacity() const { return size_; }
+
+private:
+  // The offset is the only member written after construction, keep it on its
+  // own cache line so readers of size_ and data don't bounce with it.
+  alignas(64) std::atomic<size_t> current_offset_{0}; ///< The current offset.
+  alignas(64) size_t size_; ///< The total size of the memory arena.
+  char *data = nullptr;     ///< Pointer to the allocated memory block.
+};
+
+} // namespace Spektral::Arenas
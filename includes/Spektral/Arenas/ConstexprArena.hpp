@@ -0,0 +1,118 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace Spektral::Arenas {
+
+/**
+ * @class ConstexprArena
+ * @brief A typed linear arena usable both at runtime and during constant
+ * evaluation.
+ *
+ * Constant evaluation can't reinterpret raw bytes as objects, so unlike the
+ * other arenas this one is typed: its block is a `std::allocator<T>`
+ * allocation and every object in it is created with `std::construct_at`. The
+ * same builder code can then run in a `constexpr` function, e.g. to
+ * precompute a lookup table or a small graph, and at runtime.
+ *
+ * Memory allocated during constant evaluation has to be freed before it
+ * ends, so a compile time result must be copied out of the arena (into a
+ * `std::array` for instance) before the arena goes out of scope:
+ *
+ *     constexpr auto table = [] {
+ *       ConstexprArena<Node> arena(64);
+ *       Node *root = build(arena);
+ *       return flatten<64>(root); // std::array<int, 64>
+ *     }();
+ *
+ * @tparam T The type of the objects in the arena.
+ *
+ * @note Unlike most arenas, destructors ARE called, newest first, on
+ * `reset()` and when the arena goes out of scope.
+ */
+template <typename T> class ConstexprArena {
+public:
+  /**
+   * @brief Deleted default constructor.
+   */
+  ConstexprArena() = delete;
+
+  /**
+   * @brief Constructs a ConstexprArena.
+   * @param capacity The number of objects the arena can hold.
+   *
+   * Throws std::bad_alloc if allocation fails.
+   */
+  constexpr explicit ConstexprArena(size_t capacity)
+      : data_(std::allocator<T>().allocate(capacity)), capacity_(capacity) {}
+
+  ConstexprArena(const ConstexprArena &) = delete;
+  ConstexprArena &operator=(const ConstexprArena &) = delete;
+
+  /**
+   * @brief Destructor that destroys every object and frees the block.
+   */
+  constexpr ~ConstexprArena() {
+    reset();
+    std::allocator<T>().deallocate(data_, capacity_);
+  }
+
+  /**
+   * @brief Allocates an array of value-initialized objects.
+   * @param count The number of objects to allocate.
+   * @return A pointer to the first object, or nullptr if out of memory.
+   *
+   * @note Objects are value-initialized because constant evaluation can't
+   * use objects whose lifetime hasn't started.
+   */
+  constexpr T *alloc(size_t count) {
+    if (count > capacity_ - used_)
+      return nullptr;
+    T *ptr = data_ + used_;
+    for (size_t i = 0; i < count; ++i, ++used_)
+      std::construct_at(data_ + used_);
+    return ptr;
+  }
+
+  /**
+   * @brief Creates and initializes a new object inside the arena.
+   * @tparam Args The types of the arguments forwarded to the constructor.
+   * @param args Arguments to be forwarded to the constructor of `T`.
+   * @return A pointer to the new object, or nullptr if out of memory.
+   */
+  template <typename... Args> constexpr T *make(Args &&...args) {
+    if (used_ == capacity_)
+      return nullptr;
+    T *ptr = std::construct_at(data_ + used_, std::forward<Args>(args)...);
+    ++used_;
+    return ptr;
+  }
+
+  /**
+   * @brief Resets the memory arena.
+   *
+   * Destructors are called, newest first.
+   */
+  constexpr void reset() {
+    while (used_)
+      std::destroy_at(data_ + --used_);
+  }
+
+  /**
+   * @brief Returns the number of objects in the arena.
+   */
+  constexpr size_t size() const { return used_; }
+
+  /**
+   * @brief Returns the number of objects the arena can hold.
+   */
+  constexpr size_t capacity() const { return capacity_; }
+
+private:
+  T *data_;         ///< The block of objects.
+  size_t capacity_; ///< Number of objects the block can hold.
+  size_t used_ = 0; ///< Number of constructed objects.
+};
+
+} // namespace Spektral::Arenas
@@ -0,0 +1,132 @@
+#pragma once
+#include "LinearArena.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+namespace Spektral::Arenas {
+
+/**
+ * @class FrameArenas
+ * @brief A ring of K LinearArenas for pipelined, frame based workloads.
+ *
+ * Every frame (generation) allocates from the current arena. `advance()`
+ * starts the next generation by resetting the oldest arena and making it
+ * current, so the last K generations stay alive at any time and no memory is
+ * ever malloc'd or freed per frame.
+ *
+ * With `Fenced` set, a consumer signals with `release(generation)` that it is
+ * done reading a generation, and `advance()` waits until the generation it is
+ * about to recycle has been released. Without it the producer is trusted to
+ * keep consumers less than K generations behind.
+ *
+ * @tparam K The number of arenas in the ring, atleast 2.
+ * @tparam Fenced Whether `advance()` waits for consumers. False by default.
+ * @tparam Stats The stats policy of the arenas, `NoStats` by default.
+ */
+template <size_t K, bool Fenced = false, class Stats = NoStats>
+class FrameArenas {
+  static_assert(K >= 2, "FrameArenas needs atleast two arenas");
+
+public:
+  /**
+   * @brief Deleted default constructor.
+   */
+  FrameArenas() = delete;
+
+  /**
+   * @brief Constructs K arenas of the same size.
+   * @param size The size of every arena in bytes.
+   * @param backing Where the memory comes from. `Backing::Heap` by default.
+   *
+   * Throws std::bad_alloc if allocation fails.
+   */
+  explicit FrameArenas(size_t size, Backing backing = Backing::Heap)
+      : arenas_(make_arenas(size, backing, std::make_index_sequence<K>())) {}
+
+  FrameArenas(const FrameArenas &) = delete;
+  FrameArenas &operator=(const FrameArenas &) = delete;
+
+  /**
+   * @brief Returns the arena of the current generation.
+   */
+  BasicLinearArena<Stats> &current() { return arenas_[generation_ % K]; }
+
+  /**
+   * @brief Returns the arena of a generation that is still alive, i.e. one
+   * of the last K.
+   * @param generation The generation to look up.
+   */
+  BasicLinearArena<Stats> &operator[](uint64_t generation) {
+    return arenas_[generation % K];
+  }
+
+  /**
+   * @brief Returns the current generation, starting at 0.
+   */
+  uint64_t generation() const { return generation_; }
+
+  /**
+   * @brief Starts the next generation, recycling the oldest arena.
+   *
+   * When `Fenced`, spins (yielding) until the generation being recycled has
+   * been released.
+   */
+  void advance() {
+    if constexpr (Fenced)
+      while (!recyclable())
+        std::this_thread::yield();
+    recycle();
+  }
+
+  /**
+   * @brief Starts the next generation if the oldest arena can be recycled.
+   * @return false if `Fenced` and a consumer still reads the generation that
+   * would be recycled, the current generation doesn't change then.
+   */
+  bool try_advance() {
+    if constexpr (Fenced)
+      if (!recyclable())
+        return false;
+    recycle();
+    return true;
+  }
+
+  /**
+   * @brief Signals that a consumer is done with `generation` and every
+   * generation before it. Only meaningful when `Fenced`.
+   * @param generation The last generation the consumer read.
+   *
+   * Can be called from another thread than the producer, but generations
+   * have to be released in order.
+   */
+  void release(uint64_t generation) {
+    released_.store(generation + 1, std::memory_order_release);
+  }
+
+private:
+  template <size_t... Is>
+  static std::array<BasicLinearArena<Stats>, K>
+  make_arenas(size_t size, Backing backing, std::index_sequence<Is...>) {
+    return {{((void)Is, BasicLinearArena<Stats>(size, backing))...}};
+  }
+
+  // The next generation reuses the arena of generation_ + 1 - K.
+  bool recyclable() const {
+    return generation_ + 1 < released_.load(std::memory_order_acquire) + K;
+  }
+
+  void recycle() {
+    ++generation_;
+    current().reset();
+  }
+
+  std::array<BasicLinearArena<Stats>, K> arenas_; ///< The ring of arenas.
+  uint64_t generation_ = 0; ///< The current generation.
+  std::atomic<uint64_t> released_{0}; ///< Generations consumers are done with.
+};
+
+} // namespace Spektral::Arenas
@@ -0,0 +1,254 @@
+#pragma once
+#include "utils.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace Spektral::Arenas {
+
+/**
+ * @brief What a GrowableArena does with its extra blocks on `reset()`.
+ */
+enum class ResetPolicy {
+  Release, ///< Free every block except the first one.
+  Retain   ///< Keep every block and reuse them on the next cycle.
+};
+
+/**
+ * @class GrowableArena
+ * @brief A linear arena that chains new blocks instead of running out.
+ *
+ * Behaves like LinearArena, but when the current block is exhausted a new
+ * block of `growth_factor` times the previous size (or the size of the
+ * request, whichever is larger) is linked in and allocation continues there.
+ * The fast path is still a single compare-and-add on the current block.
+ *
+ * @note Only use with trivially destroyable types as destructors ARE NOT called
+ * when the arena goes out of scope.
+ */
+class GrowableArena {
+public:
+  /**
+   * @brief Deleted default constructor.
+   */
+  GrowableArena() = delete;
+
+  /**
+   * @brief Constructs a GrowableArena with a given initial block size.
+   * @param size The size of the first block in bytes.
+   * @param growth_factor How much bigger each new block is than the previous
+   * one. 2 by default.
+   * @param policy What to do with the extra blocks on `reset()`.
+   *
+   * Throws std::bad_alloc if the first block can't be allocated.
+   *
+   * @note Actual block sizes are based on `optimal_alloc(size)`
+   */
+  explicit GrowableArena(size_t size, double growth_factor = 2.0,
+                         ResetPolicy policy = ResetPolicy::Release)
+      : growth_factor_(growth_factor < 1.0 ? 1.0 : growth_factor),
+        policy_(policy) {
+    head_ = new_block(size);
+    if (!head_)
+      throw std::bad_alloc();
+    use(head_);
+  }
+
+  GrowableArena(const GrowableArena &) = delete;
+  GrowableArena &operator=(const GrowableArena &) = delete;
+
+  /**
+   * @brief Destructor that frees every block in the chain.
+   */
+  ~GrowableArena() {
+    while (head_) {
+      Block *next = head_->next;
+      free(head_);
+      head_ = next;
+    }
+  }
+
+  /**
+   * @brief Allocates a block of memory from the arena.
+   * @param size The number of bytes to allocate.
+   * @return A pointer to the allocated memory, or nullptr if a new block
+   * could not be allocated.
+   */
+  inline void *alloc(size_t size) {
+    if (size > static_cast<size_t>(end_ - cursor_))
+      return alloc_slow(size, 1);
+    void *ptr = cursor_;
+    cursor_ += size;
+    return ptr;
+  }
+
+  /**
+   * @brief Allocates memory for an array of objects of type T.
+   * @tparam T The type of object to allocate.
+   * @param count The number of objects to allocate.
+   * @param align Define wether the block should be aligned. True by default.
+   * @return A pointer to the allocated memory, or nullptr if a new block
+   * could not be allocated.
+   */
+  template <typename T> T *alloc(size_t count, bool align = true) {
+    if (count > SIZE_MAX / sizeof(T))
+      return nullptr;
+    size_t alignment = align ? alignof(T) : 1;
+    size_t required_size = sizeof(T) * count;
+    size_t padding =
+        -reinterpret_cast<uintptr_t>(cursor_) & (alignment - 1);
+    size_t available = end_ - cursor_;
+    if (padding > available || required_size > available - padding)
+      return static_cast<T *>(alloc_slow(required_size, alignment));
+    T *ptr = reinterpret_cast<T *>(cursor_ + padding);
+    cursor_ += padding + required_size;
+    return ptr;
+  }
+
+  /**
+   * @brief Allocates and zero-initializes memory for an array of objects of
+   * type T.
+   * @tparam T The type of object to allocate.
+   * @param blocks The number of objects to allocate.
+   * @return A pointer to the allocated memory, or nullptr if out of memory.
+   */
+  template <typename T> T *calloc(size_t blocks) {
+    T *ptr = alloc<T>(blocks);
+    if (ptr)
+      memset(ptr, 0, sizeof(T) * blocks);
+    return ptr;
+  }
+
+  /**
+   * @brief Creates and initializes a new object of type `T` inside the arena.
+   * @tparam T The type of the object to be constructed.
+   * @tparam Args The types of the arguments forwarded to the constructor.
+   * @param args Arguments to be forwarded to the constructor of `T`.
+   * @return A pointer to the new object, or nullptr if out of memory.
+   *
+   * @note Destructors won't get called.
+   */
+  template <typename T, typename... Args> T *make(Args &&...args) {
+    T *ptr = alloc<T>(1);
+    return ptr ? new (ptr) T(std::forward<Args>(args)...) : nullptr;
+  }
+
+  /**
+   * @brief Resets the memory arena.
+   *
+   * Allocation restarts at the beginning of the first block. Depending on
+   * the ResetPolicy the other blocks are either freed or kept around for the
+   * next cycle.
+   *
+   * Destructors won't be called.
+   */
+  void reset() {
+    if (policy_ == ResetPolicy::Release) {
+      Block *block = head_->next;
+      while (block) {
+        Block *next = block->next;
+        free(block);
+        block = next;
+      }
+      head_->next = nullptr;
+      next_size_ = grown(head_->size);
+    }
+    use(head_);
+  }
+
+  /**
+   * @brief Returns the number of blocks currently in the chain.
+   */
+  size_t block_count() const {
+    size_t count = 0;
+    for (Block *block = head_; block; block = block->next)
+      ++count;
+    return count;
+  }
+
+  /**
+   * @brief Returns the total usable capacity of every block in the chain.
+   */
+  size_t capacity() const {
+    size_t total = 0;
+    for (Block *block = head_; block; block = block->next)
+      total += block->size;
+    return total;
+  }
+
+private:
+  /**
+   * @brief Header placed at the start of every block, the usable memory
+   * follows right after it.
+   */
+  struct alignas(std::max_align_t) Block {
+    Block *next; ///< The next block in the chain.
+    size_t size; ///< Usable bytes after the header.
+  };
+
+  Block *new_block(size_t size) {
+    // No object can be bigger than PTRDIFF_MAX, and optimal_alloc rounds up
+    // through a double, keep it far from wrapping around.
+    if (size > PTRDIFF_MAX - sizeof(Block))
+      return nullptr;
+    size_t total = optimal_alloc(size + sizeof(Block));
+    Block *block = static_cast<Block *>(malloc(total));
+    if (!block)
+      return nullptr;
+    block->next = nullptr;
+    block->size = total - sizeof(Block);
+    next_size_ = grown(block->size);
+    return block;
+  }
+
+  void use(Block *block) {
+    current_ = block;
+    cursor_ = reinterpret_cast<char *>(block + 1);
+    end_ = cursor_ + block->size;
+  }
+
+  size_t grown(size_t size) const {
+    return static_cast<size_t>(size * growth_factor_);
+  }
+
+  // Kept out of line of the fast path, moves on to the next retained block or
+  // links a new one at the end of the chain.
+  void *alloc_slow(size_t size, size_t alignment) {
+    if (size > SIZE_MAX - sizeof(Block) - alignment)
+      return nullptr;
+    // The block payload is aligned to max_align_t, anything bigger needs slack
+    size_t needed =
+        size + (alignment > alignof(std::max_align_t) ? alignment : 0);
+    while (current_->next) {
+      use(current_->next);
+      if (needed <= current_->size)
+        return bump(size, alignment);
+    }
+    Block *block = new_block(needed > next_size_ ? needed : next_size_);
+    if (!block)
+      return nullptr;
+    current_->next = block;
+    use(block);
+    return bump(size, alignment);
+  }
+
+  void *bump(size_t size, size_t alignment) {
+    cursor_ += -reinterpret_cast<uintptr_t>(cursor_) & (alignment - 1);
+    void *ptr = cursor_;
+    cursor_ += size;
+    return ptr;
+  }
+
+  char *cursor_ = nullptr;   ///< Next free byte in the current block.
+  char *end_ = nullptr;      ///< End of the current block.
+  Block *current_ = nullptr; ///< Block allocations are served from.
+  Block *head_ = nullptr;    ///< First block of the chain, never freed.
+  size_t next_size_ = 0;     ///< Size of the next block to allocate.
+  double growth_factor_;     ///< Growth factor between blocks.
+  ResetPolicy policy_;       ///< What to do with extra blocks on reset.
+};
+
+} // namespace Spektral::Arenas
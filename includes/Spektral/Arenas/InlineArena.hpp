@@ -0,0 +1,180 @@
+#pragma once
+#include "LinearArena.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace Spektral::Arenas {
+
+/**
+ * @class InlineArena
+ * @brief A fixed-capacity linear arena whose memory lives inside the object.
+ *
+ * The storage is an aligned `std::byte[N]` member, so an InlineArena on the
+ * stack or embedded in another object never touches the heap. That makes it
+ * cheap enough to create and drop millions of small scratch arenas.
+ *
+ * With `FallbackSize` set, a heap `LinearArena` of that size is created the
+ * first time the inline storage runs out and every later allocation that
+ * doesn't fit inline goes there. It is kept across `reset()`.
+ *
+ * @tparam N The size of the inline storage in bytes.
+ * @tparam FallbackSize The size of the heap arena used once the inline
+ * storage is exhausted, 0 (default) to fail instead.
+ * @tparam Stats The stats policy of the fallback arena, `NoStats` by
+ * default.
+ *
+ * @note Destructors ARE NOT called when the arena goes out of scope.
+ */
+template <size_t N, size_t FallbackSize = 0, class Stats = NoStats>
+class InlineArena {
+  static_assert(N > 0, "InlineArena needs some inline storage");
+
+public:
+  /**
+   * @brief Constructs an empty InlineArena, no memory is allocated.
+   */
+  InlineArena() = default;
+
+  InlineArena(const InlineArena &) = delete;
+  InlineArena &operator=(const InlineArena &) = delete;
+
+  /**
+   * @brief Allocates a block of memory from the arena.
+   * @param size The number of bytes to allocate.
+   * @return A pointer to the allocated memory, or nullptr if out of memory.
+   */
+  inline void *alloc(size_t size) {
+    if (size > N - offset_)
+      return alloc_fallback(size, 1);
+    void *ptr = storage_ + offset_;
+    offset_ += size;
+    return ptr;
+  }
+
+  /**
+   * @brief Allocates a block of memory with a given alignment from the arena.
+   * @param size The number of bytes to allocate.
+   * @param alignment The alignment of the block, must be a power of two.
+   * @return A pointer to the allocated memory, or nullptr if out of memory.
+   */
+  inline void *alloc_aligned(size_t size, size_t alignment) {
+    size_t padding =
+        -reinterpret_cast<uintptr_t>(storage_ + offset_) & (alignment - 1);
+    if (padding > N - offset_ || size > N - offset_ - padding)
+      return alloc_fallback(size, alignment);
+    offset_ += padding;
+    void *ptr = storage_ + offset_;
+    offset_ += size;
+    return ptr;
+  }
+
+  /**
+   * @brief Allocates memory for an array of objects of type T.
+   * @tparam T The type of object to allocate.
+   * @param count The number of objects to allocate.
+   * @return A pointer to the allocated memory, or nullptr if out of memory.
+   */
+  template <typename T> T *alloc(size_t count) {
+    if (count > (N > FallbackSize ? N : FallbackSize) /
+                    (sizeof(T) ? sizeof(T) : 1))
+      return nullptr;
+    return static_cast<T *>(alloc_aligned(sizeof(T) * count, alignof(T)));
+  }
+
+  /**
+   * @brief Allocates and zero-initializes memory for an array of objects of
+   * type T.
+   * @tparam T The type of object to allocate.
+   * @param count The number of objects to allocate.
+   * @return A pointer to the allocated memory, or nullptr if out of memory.
+   */
+  template <typename T> T *calloc(size_t count) {
+    T *ptr = alloc<T>(count);
+    if (ptr)
+      memset(ptr, 0, sizeof(T) * count);
+    return ptr;
+  }
+
+  /**
+   * @brief Creates and initializes a new object of type `T` inside the arena.
+   * @tparam T The type of the object to be constructed.
+   * @tparam Args The types of the arguments forwarded to the constructor.
+   * @param args Arguments to be forwarded to the constructor of `T`.
+   * @return A pointer to the new object, or nullptr if out of memory.
+   *
+   * @note Destructors won't get called.
+   */
+  template <typename T, typename... Args> T *make(Args &&...args) {
+    T *ptr = alloc<T>(1);
+    return ptr ? new (ptr) T(std::forward<Args>(args)...) : nullptr;
+  }
+
+  /**
+   * @brief Resets the memory arena, including the fallback arena if there is
+   * one.
+   *
+   * Destructors won't be called.
+   */
+  void reset() {
+    offset_ = 0;
+    if (fallback_)
+      fallback_->reset();
+  }
+
+  /**
+   * @brief Checks whether a pointer points into the arena.
+   * @param ptr The pointer to check.
+   * @return true if `ptr` lies inside the inline storage or the fallback
+   * arena.
+   */
+  bool owns(const void *ptr) const {
+    const std::byte *p = static_cast<const std::byte *>(ptr);
+    return (p >= storage_ && p < storage_ + N) ||
+           (fallback_ && fallback_->owns(ptr));
+  }
+
+  /**
+   * @brief Checks whether the inline storage ran out and the fallback arena
+   * was created.
+   */
+  bool spilled() const { return fallback_ != nullptr; }
+
+  /**
+   * @brief Returns the fallback arena, e.g. to read its stats, or nullptr if
+   * the inline storage never ran out.
+   */
+  const BasicLinearArena<Stats> *fallback() const { return fallback_.get(); }
+
+  /**
+   * @brief Returns the size of the inline storage in bytes.
+   */
+  static constexpr size_t capacity() { return N; }
+
+private:
+  // Slow path, only taken once the inline storage is exhausted.
+  void *alloc_fallback(size_t size, size_t alignment) {
+    if constexpr (FallbackSize == 0) {
+      return nullptr;
+    } else {
+      if (!fallback_) {
+        try {
+          fallback_ = std::make_unique<BasicLinearArena<Stats>>(FallbackSize);
+        } catch (const std::bad_alloc &) {
+          return nullptr;
+        }
+      }
+      return fallback_->alloc_aligned(size, alignment);
+    }
+  }
+
+  alignas(std::max_align_t) std::byte storage_[N]; ///< The inline storage.
+  size_t offset_ = 0; ///< Offset in the inline storage.
+  /// Heap arena, once spilled.
+  std::unique_ptr<BasicLinearArena<Stats>> fallback_;
+};
+
+} // namespace Spektral::Arenas
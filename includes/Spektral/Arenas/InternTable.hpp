@@ -0,0 +1,147 @@
+#pragma once
+#include "ArenaHashMap.hpp"
+#include "ArenaVector.hpp"
+#include "LinearArena.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string_view>
+
+namespace Spektral::Arenas {
+
+/**
+ * @class BasicInternTable
+ * @brief Stores every distinct string once in a `LinearArena`.
+ *
+ * `intern` copies a string into the arena the first time it is seen and
+ * returns a dense 32 bit id, the same one every later time. Comparing ids is
+ * comparing strings, and `str(id)` gives back a `std::string_view` that stays
+ * valid until the arena is reset.
+ *
+ * The index is an `ArenaHashMap` in the same arena. Every call takes a hash
+ * computed once by the caller (or by the overload without one), so a lookup
+ * that misses and then inserts doesn't hash twice.
+ *
+ * @tparam Stats The stats policy of the arena, see `BasicLinearArena`.
+ *
+ * @note Reusing the table after a `reset()` of its arena is undefined.
+ */
+template <class Stats> class BasicInternTable {
+public:
+  using Id = uint32_t;
+
+  /**
+   * @brief The id returned when a string isn't in the table or the arena is
+   * full.
+   */
+  static constexpr Id invalid = ~Id{0};
+
+  /**
+   * @brief Deleted default constructor.
+   */
+  BasicInternTable() = delete;
+
+  /**
+   * @brief Constructs an empty table.
+   * @param arena The arena the strings and the index are allocated from.
+   * @param expected The number of distinct strings to make room for up
+   * front. 0 by default.
+   *
+   * Up to `expected` strings, nothing but the strings themselves is allocated
+   * after construction, so they end up back to back in the arena.
+   */
+  explicit BasicInternTable(BasicLinearArena<Stats> &arena,
+                            size_t expected = 0)
+      : arena_(&arena), index_(arena), strings_(arena) {
+    if (expected) {
+      index_.reserve(expected);
+      strings_.reserve(expected);
+    }
+  }
+
+  BasicInternTable(const BasicInternTable &) = delete;
+  BasicInternTable &operator=(const BasicInternTable &) = delete;
+
+  /**
+   * @brief Returns the hash `intern` and `find` expect for a string.
+   */
+  static size_t hash(std::string_view str) {
+    return std::hash<std::string_view>{}(str);
+  }
+
+  /**
+   * @brief Returns the id of a string, copying it into the arena if it is new.
+   * @param str The string to intern.
+   * @param hash `hash(str)`.
+   * @return The id of the string, or `invalid` if out of memory.
+   */
+  Id intern(std::string_view str, size_t hash) {
+    if (const Id *id = index_.find(str, hash))
+      return *id;
+    if (strings_.size() >= invalid || !strings_.reserve(strings_.size() + 1))
+      return invalid;
+    char *copy = arena_->template alloc<char>(str.size(), false);
+    if (!copy)
+      return invalid;
+    if (!str.empty())
+      memcpy(copy, str.data(), str.size());
+    std::string_view stored{copy, str.size()};
+    Id id = static_cast<Id>(strings_.size());
+    if (!index_.try_emplace_hashed(hash, stored, id).first) {
+      arena_->rollback(copy, str.size());
+      return invalid;
+    }
+    strings_.push_back(stored);
+    return id;
+  }
+
+  /**
+   * @brief Returns the id of a string, copying it into the arena if it is new.
+   * @param str The string to intern.
+   * @return The id of the string, or `invalid` if out of memory.
+   */
+  Id intern(std::string_view str) { return intern(str, hash(str)); }
+
+  /**
+   * @brief Returns the id of a string without interning it.
+   * @param str The string to look up.
+   * @param hash `hash(str)`.
+   * @return The id of the string, or `invalid` if it isn't in the table.
+   */
+  Id find(std::string_view str, size_t hash) const {
+    const Id *id = index_.find(str, hash);
+    return id ? *id : invalid;
+  }
+
+  /**
+   * @brief Returns the id of a string without interning it.
+   * @return The id of the string, or `invalid` if it isn't in the table.
+   */
+  Id find(std::string_view str) const { return find(str, hash(str)); }
+
+  /**
+   * @brief Returns the interned copy of a string.
+   * @param id An id returned by `intern`.
+   */
+  std::string_view str(Id id) const { return strings_[id]; }
+
+  /**
+   * @brief Returns the number of distinct strings.
+   */
+  size_t size() const { return strings_.size(); }
+
+private:
+  BasicLinearArena<Stats> *arena_; ///< Owner of the strings.
+  ArenaHashMap<std::string_view, Id, std::hash<std::string_view>,
+               std::equal_to<std::string_view>, Stats>
+      index_;                                    ///< String to id.
+  ArenaVector<std::string_view, Stats> strings_; ///< Id to string.
+};
+
+/**
+ * @brief The intern table over a `LinearArena`, without stats.
+ */
+using InternTable = BasicInternTable<NoStats>;
+
+} // namespace Spektral::Arenas
@@ -1,10 +1,18 @@
+#pragma once
+#include "Backing.hpp"
+#include "Stats.hpp"
 #include "utils.hpp"
+#include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <iterator>
 #include <memory>
 #include <new>
+#include <span>
+#include <type_traits>
 #include <unistd.h>
 #include <utility>
 #include <vector>
@@ -12,44 +20,75 @@
 namespace Spektral::Arenas {
 
 /**
- * @class LinearArena
+ * @class BasicLinearArena
  * @brief A simple memory arena for fast memory allocations.
  *
  * This class provides a linear allocator that allocates memory in a contiguous
  * block. It does not support deallocation of individual allocations but allows
  * resetting the entire arena.
  *
- * @note Only use with trivially destroyable types as destructors ARE NOT called
- * when the arena goes out of scope.
+ * Use it through `LinearArena`, which records no stats, or
+ * `BasicLinearArena<ArenaStats>` to find out how an arena is used, see
+ * `stats()`.
+ *
+ * @tparam Stats The stats policy, `NoStats` or `ArenaStats`.
+ *
+ * @note Destructors are only called for objects created with `make`, memory
+ * returned by `alloc` and `calloc` is never destroyed.
  */
-class LinearArena {
+template <class Stats> class BasicLinearArena {
 public:
+  /**
+   * @brief A saved position in the arena, taken with `mark()` and restored
+   * with `rewind()`.
+   */
+  struct Marker {
+    size_t offset; ///< The saved offset.
+#ifndef NDEBUG
+    size_t generation; ///< Number of resets when the marker was taken.
+    size_t sequence;   ///< Number of markers taken before this one, plus one.
+#endif
+  };
+
+  class ScopedRewind;
+  class Batch;
+
   /**
    * @brief Deleted default constructor.
    */
-  LinearArena() = delete;
+  BasicLinearArena() = delete;
 
   /**
-   * @brief Constructs a LinearArena with a given size.
+   * @brief Constructs a BasicLinearArena with a given size.
    * @param size The total size of the memory arena in bytes. 4096 by default
    * since that can hold 1024 ints(arbitrary requirement choosen by me).
+   * @param backing Where the memory comes from. `Backing::Heap` by default.
    *
    * Allocates a contiguous block of memory of atleast the specified size.
    * Throws std::bad_alloc if allocation fails.
    *
+   * With `Backing::VirtualMemory` the block is only reserved and pages are
+   * committed as the arena grows into them, so `size` can be as large as the
+   * address space allows. With `Backing::HugePages` the block is backed by 2MB
+   * pages when the system has them, see `huge_pages()`.
+   *
    * @note Actual allocated size is based on `optimal_alloc(size)`
    */
-  explicit LinearArena(size_t size) : current_offset_(0) {
-    size_ = optimal_alloc(size);
-    data = static_cast<char *>(malloc(size));
-    if (!data)
-      throw std::bad_alloc();
+  explicit BasicLinearArena(size_t size, Backing backing = Backing::Heap)
+      : region_(size, backing), current_offset_(0) {
+    size_ = region_.size();
+    committed_ = region_.committed();
+    data = region_.data();
   }
 
+  BasicLinearArena(const BasicLinearArena &) = delete;
+  BasicLinearArena &operator=(const BasicLinearArena &) = delete;
+
   /**
-   * @brief Destructor that frees the allocated memory.
+   * @brief Destructor that calls the destructors of objects created with
+   * `make` and frees the allocated memory.
    */
-  ~LinearArena() { free(data); }
+  ~BasicLinearArena() { run_destructors(0); }
 
   /**
    * @brief Allocates a block of memory from the arena.
@@ -63,10 +102,47 @@ public:
    * function call overhead is comporable to the offset incrementation overhead
    */
   inline void *alloc(size_t size) {
-    if (current_offset_ + size > size_)
+    if (current_offset_ + size > committed_ &&
+        !commit(current_offset_ + size)) {
+      stats_.record_failure(size);
       return nullptr;
+    }
     void *ptr = data + current_offset_;
     current_offset_ += size;
+    stats_.record_alloc(size, 0);
+    stats_.record_usage(current_offset_);
+    return ptr;
+  }
+
+  /**
+   * @brief Allocates a block of memory with a given alignment from the arena.
+   * @param size The number of bytes to allocate.
+   * @param alignment The alignment of the block, must be a power of two.
+   * @return A pointer to the allocated memory, or nullptr if out of memory.
+   */
+  inline void *alloc_aligned(size_t size, size_t alignment) {
+    size_t remainder =
+        reinterpret_cast<uintptr_t>(data + current_offset_) & (alignment - 1);
+    // if the data is already aligned don't align
+    if (!remainder)
+      return alloc(size);
+    // This is different from the standard padding formula:
+    // padding = (alignment - (address % alignment)) % alignment;
+    // because we've already checked for the block being aligned in the first
+    // gaurd block.
+    size_t padding = alignment - remainder;
+
+    if (current_offset_ + padding + size > committed_ &&
+        !commit(current_offset_ + padding + size)) {
+      stats_.record_failure(size);
+      return nullptr;
+    }
+
+    current_offset_ += padding;
+    void *ptr = data + current_offset_;
+    current_offset_ += size;
+    stats_.record_alloc(size, padding);
+    stats_.record_usage(current_offset_);
     return ptr;
   }
 
@@ -81,26 +157,43 @@ public:
    * like to disable this, call with alloc<T>(count, false);
    */
   template <typename T> T *alloc(size_t count, bool align = true) {
-    size_t remainder;
-    size_t alignment = alignof(T);
-    size_t required_size = sizeof(T);
-    // if the user doesn't want alignment or the data is already aligned
-    // don't align
-    if (!align || !(remainder = (current_offset_ % alignment)))
-      return static_cast<T *>(alloc(required_size * count));
-    // This is different from the standard padding formula:
-    // padding = (alignment - (current_offset_ % alignment)) % alignment;
-    // because we've already checked for the block being aligned in the first
-    // gaurd block.
-    size_t padding = alignment - remainder;
+    if (!align)
+      return static_cast<T *>(alloc(sizeof(T) * count));
+    return static_cast<T *>(alloc_aligned(sizeof(T) * count, alignof(T)));
+  }
 
-    if (current_offset_ + padding + required_size > size_)
-      return nullptr;
+  /**
+   * @brief Allocates `n` blocks of `size` bytes with a single bounds check.
+   * @param size The size of every block in bytes.
+   * @param n The number of blocks to allocate.
+   * @param alignment The alignment of every block, a power of two. 1 by
+   * default.
+   * @return The blocks as a strided range, empty (false) if out of memory.
+   *
+   * Blocks are laid out back to back, `size` rounded up to `alignment` apart.
+   */
+  inline Batch alloc_n(size_t size, size_t n, size_t alignment = 1);
 
-    current_offset_ += padding;
-    T *ptr = static_cast<T *>(data + current_offset_);
-    current_offset_ += required_size;
-    return ptr;
+  /**
+   * @brief Allocates `out.size()` arrays of `count` objects of type T with a
+   * single bounds check.
+   * @tparam T The type of object to allocate.
+   * @param count The number of objects in every array.
+   * @param out Receives a pointer to every array.
+   * @return false if out of memory, `out` is left untouched then.
+   */
+  template <typename T> bool alloc_batch(size_t count, std::span<T *> out) {
+    if (count > size_ / (sizeof(T) ? sizeof(T) : 1))
+      return false;
+    size_t stride = sizeof(T) * count;
+    if (stride && out.size() > size_ / stride)
+      return false;
+    T *ptr = static_cast<T *>(alloc_aligned(stride * out.size(), alignof(T)));
+    if (!ptr)
+      return false;
+    for (size_t i = 0; i < out.size(); ++i)
+      out[i] = ptr + i * count;
+    return true;
   }
 
   /**
@@ -114,11 +207,16 @@ public:
    * zero.
    */
   template <typename T> T *calloc(size_t blocks) {
-    if (current_offset_ + sizeof(T) * blocks > size_)
+    if (current_offset_ + sizeof(T) * blocks > committed_ &&
+        !commit(current_offset_ + sizeof(T) * blocks)) {
+      stats_.record_failure(sizeof(T) * blocks);
       return nullptr;
+    }
     memset(data + current_offset_, 0, sizeof(T) * blocks);
     void *ptr = data + current_offset_;
     current_offset_ += sizeof(T) * blocks;
+    stats_.record_alloc(sizeof(T) * blocks, 0);
+    stats_.record_usage(current_offset_);
     return static_cast<T *>(ptr);
   }
 
@@ -137,14 +235,48 @@ public:
    *
    * @param args Arguments to be forwarded to the constructor of `T`.
    *
-   * @return A pointer to the newly constructed object of type `T`.
+   * @return A pointer to the newly constructed object of type `T`, or nullptr
+   * if out of memory.
    *
    * @note This pointer is allocated throught the arena so it's life time is
-   * tied to the arena. Destructors won't get called.
+   * tied to the arena. If `T` is not trivially destructible, a small record is
+   * stored in the arena next to the object and its destructor runs on
+   * `reset()`, `rewind()` past it, or when the arena is destroyed, in reverse
+   * order of creation. Trivially destructible types don't pay for it.
    */
-  template <typename T, typename... Args> T *make(Args... args) {
-    // placement new using the arena + forwarded arguments
-    return new (static_cast<T *>(alloc(sizeof(T)))) T(std::forward(args)...);
+  template <typename T, typename... Args> T *make(Args &&...args) {
+    if constexpr (std::is_trivially_destructible_v<T>) {
+      T *ptr = alloc<T>(1);
+      // placement new using the arena + forwarded arguments
+      return ptr ? new (ptr) T(std::forward<Args>(args)...) : nullptr;
+    } else {
+      // Stats only see the object: the record is bookkeeping, and nothing is
+      // recorded until the object is actually constructed.
+      size_t offset = current_offset_;
+      T *ptr = static_cast<T *>(claim(sizeof(T), alignof(T)));
+      Destructor *record =
+          ptr ? static_cast<Destructor *>(
+                    claim(sizeof(Destructor), alignof(Destructor)))
+              : nullptr;
+      if (!record) {
+        current_offset_ = offset;
+        stats_.record_failure(sizeof(T));
+        return nullptr;
+      }
+      try {
+        new (ptr) T(std::forward<Args>(args)...);
+      } catch (...) {
+        current_offset_ = offset;
+        throw;
+      }
+      *record = {ptr, [](void *obj) { static_cast<T *>(obj)->~T(); },
+                 destructors_};
+      destructors_ = record;
+      stats_.record_alloc(sizeof(T), current_offset_ - offset - sizeof(T) -
+                                         sizeof(Destructor));
+      stats_.record_usage(current_offset_);
+      return ptr;
+    }
   }
 
   /**
@@ -153,14 +285,386 @@ public:
    * This function resets the arena by setting the allocation offset to zero,
    * effectively making all previously allocated memory available again.
    *
-   * Destructors won't be called.
+   * Destructors of objects created with `make` are called, newest first.
+   */
+  void reset() {
+    run_destructors(0);
+    current_offset_ = 0;
+#ifndef NDEBUG
+    ++generation_;
+    live_markers_.clear();
+#endif
+  }
+
+  /**
+   * @brief Resizes an allocation, in place when it is the most recent one.
+   * @param ptr A block allocated from this arena, or nullptr.
+   * @param old_size The current size of the block in bytes.
+   * @param new_size The requested size of the block in bytes.
+   * @param alignment The alignment of a new block if one is needed, a power
+   * of two. `alignof(std::max_align_t)` by default.
+   * @return The resized block, or nullptr if out of memory (`ptr` is left
+   * untouched then).
+   *
+   * The most recent allocation grows or shrinks by just moving the offset.
+   * Any other block is returned as is when shrinking, and copied into a new
+   * block when growing, the old one is only given back on `reset()`.
+   */
+  void *extend(void *ptr, size_t old_size, size_t new_size,
+               size_t alignment = alignof(std::max_align_t)) {
+    char *block = static_cast<char *>(ptr);
+    if (block && is_last(block, old_size)) {
+      size_t start = block - data;
+      if (new_size > size_ - start ||
+          (start + new_size > committed_ && !commit(start + new_size))) {
+        stats_.record_failure(new_size);
+        return nullptr;
+      }
+      current_offset_ = start + new_size;
+      if (new_size > old_size)
+        stats_.record_extend(new_size - old_size);
+      stats_.record_usage(current_offset_);
+      return block;
+    }
+    if (block && new_size <= old_size)
+      return block;
+    void *grown = alloc_aligned(new_size, alignment);
+    if (grown && block)
+      memcpy(grown, block, old_size);
+    return grown;
+  }
+
+  /**
+   * @brief Resizes an array of objects of type T, in place when it is the
+   * most recent allocation.
+   * @tparam T The type of the objects, must be trivially copyable.
+   * @param ptr An array allocated from this arena, or nullptr.
+   * @param old_count The current number of objects.
+   * @param new_count The requested number of objects.
+   * @return The resized array, or nullptr if out of memory (`ptr` is left
+   * untouched then).
+   *
+   * See `extend`.
+   */
+  template <typename T> T *realloc(T *ptr, size_t old_count, size_t new_count) {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "realloc moves objects with memcpy");
+    if (new_count > size_ / (sizeof(T) ? sizeof(T) : 1))
+      return nullptr;
+    return static_cast<T *>(
+        extend(ptr, sizeof(T) * old_count, sizeof(T) * new_count, alignof(T)));
+  }
+
+  /**
+   * @brief Gives back the most recent allocation.
+   * @param ptr The pointer returned by the allocation.
+   * @param size The size of the allocation in bytes.
+   * @return true if `ptr` was the most recent allocation and its memory was
+   * given back, false otherwise (the call is then a no-op).
+   */
+  bool rollback(void *ptr, size_t size) {
+    if (!is_last(ptr, size))
+      return false;
+    current_offset_ -= size;
+    return true;
+  }
+
+  /**
+   * @brief Checks whether a block is the most recent allocation.
+   * @param ptr The pointer returned by the allocation.
+   * @param size The size of the allocation in bytes.
+   * @return true if the block ends exactly where the next allocation starts.
+   */
+  bool is_last(const void *ptr, size_t size) const {
+    return static_cast<const char *>(ptr) + size == data + current_offset_;
+  }
+
+  /**
+   * @brief Checks whether a pointer points into the arena.
+   * @param ptr The pointer to check.
+   * @return true if `ptr` lies inside the arena's memory block.
+   */
+  bool owns(const void *ptr) const {
+    const char *p = static_cast<const char *>(ptr);
+    return p >= data && p < data + size_;
+  }
+
+  /**
+   * @brief Saves the current position in the arena.
+   * @return A marker that can be passed to `rewind()`.
+   */
+  Marker mark() const {
+#ifndef NDEBUG
+    // A marker at the same offset as the newest live one is interchangeable
+    // with it, reusing it keeps a mark/rewind loop from growing the list.
+    if (live_markers_.empty() ||
+        live_markers_.back().offset != current_offset_)
+      live_markers_.push_back({current_offset_, generation_, ++markers_});
+    return live_markers_.back();
+#else
+    return {current_offset_};
+#endif
+  }
+
+  /**
+   * @brief Frees everything allocated since `marker` was taken.
+   * @param marker A marker taken on this arena.
+   *
+   * Markers have to be restored in LIFO order: rewinding to a marker
+   * invalidates every marker taken after it. Restoring an invalidated marker,
+   * or one taken before `reset()`, asserts in debug builds.
+   *
+   * Destructors of objects created with `make` since the marker are called,
+   * newest first.
+   */
+  void rewind(Marker marker) {
+#ifndef NDEBUG
+    assert(marker.generation == generation_ && "marker taken before reset()");
+    while (!live_markers_.empty() &&
+           live_markers_.back().sequence > marker.sequence)
+      live_markers_.pop_back();
+    assert(!live_markers_.empty() &&
+           live_markers_.back().sequence == marker.sequence &&
+           "marker restored out of order");
+#endif
+    assert(marker.offset <= current_offset_ && "marker restored out of order");
+    run_destructors(marker.offset);
+    current_offset_ = marker.offset;
+  }
+
+  /**
+   * @brief Returns the number of bytes in use, padding included.
+   */
+  size_t used() const { return current_offset_; }
+
+  /**
+   * @brief Returns the size of the arena in bytes.
+   */
+  size_t capacity() const { return size_; }
+
+  /**
+   * @brief Returns what the stats policy recorded so far.
    */
-  void reset() { current_offset_ = 0; }
+  const Stats &stats() const { return stats_; }
+
+  /**
+   * @brief Returns where the memory of the arena comes from.
+   */
+  Backing backing() const { return region_.backing(); }
+
+  /**
+   * @brief Returns which kind of huge pages the arena actually got.
+   */
+  HugePageMode huge_pages() const { return region_.huge_pages(); }
 
 private:
+  /**
+   * @brief Type-erased destructor call stored in the arena by `make`.
+   */
+  struct Destructor {
+    void *object;            ///< The object to destroy.
+    void (*destroy)(void *); ///< Calls the destructor of the right type.
+    Destructor *next;        ///< The previously registered destructor.
+  };
+
+  // Destroys every object registered at or after `offset`. Records are always
+  // allocated right after their object, so the list is sorted by address.
+  void run_destructors(size_t offset) {
+    while (destructors_ &&
+           reinterpret_cast<char *>(destructors_) >= data + offset) {
+      Destructor *record = destructors_;
+      destructors_ = record->next;
+      record->destroy(record->object);
+    }
+  }
+
+  Destructor *destructors_ = nullptr; ///< Newest destructor to call.
+#ifndef NDEBUG
+  size_t generation_ = 0; ///< Number of resets, used to catch stale markers.
+  mutable size_t markers_ = 0; ///< Number of markers taken.
+  /// Markers that can still be restored, oldest first.
+  mutable std::vector<Marker> live_markers_;
+#endif
+
+  // Moves the offset past an aligned block without recording anything.
+  void *claim(size_t size, size_t alignment) {
+    size_t padding =
+        -reinterpret_cast<uintptr_t>(data + current_offset_) & (alignment - 1);
+    if (current_offset_ + padding + size > committed_ &&
+        !commit(current_offset_ + padding + size))
+      return nullptr;
+    current_offset_ += padding;
+    void *ptr = data + current_offset_;
+    current_offset_ += size;
+    return ptr;
+  }
+
+  // Slow path of every allocation, only does something for virtual memory
+  // backed arenas whose committed part is smaller than the whole region.
+  bool commit(size_t end) {
+    if (!region_.commit(end))
+      return false;
+    committed_ = region_.committed();
+    return true;
+  }
+
+  Region region_;         ///< Owner of the memory block.
   size_t size_;           ///< The total size of the memory arena.
+  size_t committed_;      ///< How much of the arena is usable right now.
   size_t current_offset_; ///< The current offset in the memory arena.
   char *data = nullptr;   ///< Pointer to the allocated memory block.
+
+  [[no_unique_address]] Stats stats_; ///< Allocation stats, if any.
+};
+
+/**
+ * @brief The linear arena, without stats.
+ */
+using LinearArena = BasicLinearArena<NoStats>;
+
+/**
+ * @class BasicLinearArena::ScopedRewind
+ * @brief Gives back everything allocated in a scope when it ends.
+ *
+ * Takes a marker on construction and rewinds the arena to it on destruction,
+ * which turns the arena into a stack allocator for temporaries:
+ *
+ *     {
+ *       LinearArena::ScopedRewind scratch(arena);
+ *       char *buffer = arena.alloc<char>(4096);
+ *       ...
+ *     } // buffer is given back here, earlier allocations are kept
+ *
+ * Scopes can be nested freely as long as they are destroyed in reverse order.
+ */
+template <class Stats> class BasicLinearArena<Stats>::ScopedRewind {
+public:
+  /**
+   * @brief Deleted default constructor.
+   */
+  ScopedRewind() = delete;
+
+  /**
+   * @brief Saves the current position of `arena`.
+   * @param arena The arena to rewind at the end of the scope.
+   */
+  explicit ScopedRewind(BasicLinearArena &arena)
+      : arena_(arena), marker_(arena.mark()) {}
+
+  ScopedRewind(const ScopedRewind &) = delete;
+  ScopedRewind &operator=(const ScopedRewind &) = delete;
+
+  /**
+   * @brief Rewinds the arena to where it was on construction.
+   */
+  ~ScopedRewind() { arena_.rewind(marker_); }
+
+private:
+  BasicLinearArena &arena_; ///< The arena to rewind.
+  Marker marker_;           ///< Where to rewind it to.
 };
 
+/**
+ * @class BasicLinearArena::Batch
+ * @brief A strided range of blocks returned by `BasicLinearArena::alloc_n`.
+ *
+ * Holds no memory of its own, block `i` is simply `data() + i * stride()`:
+ *
+ *     for (void *block : arena.alloc_n(64, 1000))
+ *       ...
+ */
+template <class Stats> class BasicLinearArena<Stats>::Batch {
+public:
+  /**
+   * @brief Forward iterator over the blocks of a batch.
+   */
+  class iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = void *;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void **;
+    using reference = void *;
+
+    iterator() = default;
+    iterator(char *data, size_t stride, size_t index)
+        : data_(data), stride_(stride), index_(index) {}
+
+    void *operator*() const { return data_ + index_ * stride_; }
+    iterator &operator++() {
+      ++index_;
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator old = *this;
+      ++index_;
+      return old;
+    }
+    bool operator==(const iterator &other) const {
+      return index_ == other.index_;
+    }
+
+  private:
+    char *data_ = nullptr; ///< The first block.
+    size_t stride_ = 0;    ///< Distance between two blocks.
+    size_t index_ = 0;     ///< Index of the current block.
+  };
+
+  /**
+   * @brief Constructs an empty batch.
+   */
+  Batch() = default;
+
+  /**
+   * @brief Constructs a batch of `count` blocks `stride` bytes apart.
+   */
+  Batch(char *data, size_t stride, size_t count)
+      : data_(data), stride_(stride), count_(count) {}
+
+  /**
+   * @brief Returns block `i`.
+   */
+  void *operator[](size_t i) const { return data_ + i * stride_; }
+
+  /**
+   * @brief Returns the first block, or nullptr if the allocation failed.
+   */
+  void *data() const { return data_; }
+
+  /**
+   * @brief Returns the number of blocks.
+   */
+  size_t size() const { return count_; }
+
+  /**
+   * @brief Returns the distance between two blocks in bytes.
+   */
+  size_t stride() const { return stride_; }
+
+  /**
+   * @brief Returns false if the allocation failed.
+   */
+  explicit operator bool() const { return data_ != nullptr; }
+
+  iterator begin() const { return {data_, stride_, 0}; }
+  iterator end() const { return {data_, stride_, count_}; }
+
+private:
+  char *data_ = nullptr; ///< The first block.
+  size_t stride_ = 0;    ///< Distance between two blocks.
+  size_t count_ = 0;     ///< Number of blocks.
+};
+
+template <class Stats>
+inline typename BasicLinearArena<Stats>::Batch
+BasicLinearArena<Stats>::alloc_n(size_t size, size_t n, size_t alignment) {
+  size_t stride = (size + alignment - 1) & ~(alignment - 1);
+  if (stride < size || (stride && n > size_ / stride))
+    return {};
+  char *ptr = static_cast<char *>(alloc_aligned(stride * n, alignment));
+  if (!ptr)
+    return {};
+  return {ptr, stride, n};
+}
+
 } // namespace Spektral::Arenas
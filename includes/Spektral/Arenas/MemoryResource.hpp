@@ -0,0 +1,87 @@
+#pragma once
+#include "LinearArena.hpp"
+#include <cstddef>
+#include <memory_resource>
+
+namespace Spektral::Arenas {
+
+/**
+ * @class BasicArenaResource
+ * @brief A `std::pmr::memory_resource` that allocates from a LinearArena.
+ *
+ * Lets any `std::pmr` container allocate from an arena:
+ *
+ *     Spektral::Arenas::LinearArena arena(1 << 20);
+ *     Spektral::Arenas::ArenaResource resource(arena);
+ *     std::pmr::vector<int> v(&resource);
+ *
+ * Deallocating the most recent allocation gives its memory back to the arena,
+ * anything else is a no-op until the arena is reset. Once the arena is full,
+ * allocations go to the upstream resource instead, and are given back to it
+ * when deallocated.
+ *
+ * @tparam Stats The stats policy of the arena, see `BasicLinearArena`.
+ */
+template <class Stats>
+class BasicArenaResource : public std::pmr::memory_resource {
+public:
+  /**
+   * @brief Deleted default constructor.
+   */
+  BasicArenaResource() = delete;
+
+  /**
+   * @brief Constructs a memory resource on top of an arena.
+   * @param arena The arena to allocate from. Must outlive the resource.
+   * @param upstream Where allocations go once the arena is full, the default
+   * resource by default. Pass `std::pmr::null_memory_resource()` to throw
+   * std::bad_alloc instead.
+   */
+  explicit BasicArenaResource(
+      BasicLinearArena<Stats> &arena,
+      std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+      : arena_(arena), upstream_(upstream) {}
+
+  BasicArenaResource(const BasicArenaResource &) = delete;
+  BasicArenaResource &operator=(const BasicArenaResource &) = delete;
+
+  /**
+   * @brief Returns the arena allocations are served from.
+   */
+  BasicLinearArena<Stats> &arena() const { return arena_; }
+
+  /**
+   * @brief Returns the resource used once the arena is full.
+   */
+  std::pmr::memory_resource *upstream_resource() const { return upstream_; }
+
+protected:
+  void *do_allocate(size_t bytes, size_t alignment) override {
+    if (void *ptr = arena_.alloc_aligned(bytes, alignment))
+      return ptr;
+    return upstream_->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void *ptr, size_t bytes, size_t alignment) override {
+    if (arena_.owns(ptr))
+      arena_.rollback(ptr, bytes);
+    else
+      upstream_->deallocate(ptr, bytes, alignment);
+  }
+
+  bool do_is_equal(
+      const std::pmr::memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+private:
+  BasicLinearArena<Stats> &arena_;      ///< Where allocations come from.
+  std::pmr::memory_resource *upstream_; ///< Used once the arena is full.
+};
+
+/**
+ * @brief The memory resource over a `LinearArena`, without stats.
+ */
+using ArenaResource = BasicArenaResource<NoStats>;
+
+} // namespace Spektral::Arenas
@@ -0,0 +1,172 @@
+#pragma once
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <new>
+#include <span>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace Spektral::Arenas {
+
+/**
+ * @class MirroredRingArena
+ * @brief A FIFO byte ring whose buffer is mapped twice back to back.
+ *
+ * The buffer is a `memfd_create` file mapped at `base` and again right after
+ * it at `base + capacity()`, so the byte after the last one of the ring is
+ * the first one again. Anything that crosses the end of the ring is still
+ * contiguous in virtual memory: no space is skipped, `alloc()` always hands
+ * out the next `size` bytes and `readable()` returns every committed byte as
+ * a single span, ready for one zero-copy `write()`.
+ *
+ * The ring carries raw bytes, framing records is up to the caller. Bytes
+ * become readable once the producer calls `commit()` and are released with
+ * `consume()`. With `Concurrent` set, one producer thread and one consumer
+ * thread can use the arena at the same time without locks.
+ *
+ * @tparam Concurrent Whether the producer and the consumer run on different
+ * threads. False by default.
+ *
+ * @note Linux only.
+ */
+template <bool Concurrent = false> class MirroredRingArena {
+public:
+  /**
+   * @brief Deleted default constructor.
+   */
+  MirroredRingArena() = delete;
+
+  /**
+   * @brief Constructs a MirroredRingArena.
+   * @param size The size of the ring in bytes, rounded up to a power of two
+   * and atleast one page.
+   *
+   * Throws std::bad_alloc if the buffer can't be created or mapped.
+   */
+  explicit MirroredRingArena(size_t size) {
+    size_t page_size = sysconf(_SC_PAGE_SIZE);
+    size_ = std::bit_ceil(size < page_size ? page_size : size);
+    int fd = memfd_create("spektral-ring", MFD_CLOEXEC);
+    if (fd < 0)
+      throw std::bad_alloc();
+    // Reserve both halves first so nothing else can be mapped in between.
+    void *base = ftruncate(fd, size_)
+                     ? MAP_FAILED
+                     : mmap(nullptr, 2 * size_, PROT_NONE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base != MAP_FAILED) {
+      data = static_cast<char *>(base);
+      if (mmap(data, size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+               fd, 0) == MAP_FAILED ||
+          mmap(data + size_, size_, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(data, 2 * size_);
+        data = nullptr;
+      }
+    }
+    // The mappings keep the file alive.
+    close(fd);
+    if (!data)
+      throw std::bad_alloc();
+  }
+
+  MirroredRingArena(const MirroredRingArena &) = delete;
+  MirroredRingArena &operator=(const MirroredRingArena &) = delete;
+
+  /**
+   * @brief Destructor that unmaps both halves of the buffer.
+   */
+  ~MirroredRingArena() { munmap(data, 2 * size_); }
+
+  /**
+   * @brief Allocates the next `size` bytes of the ring. Producer only.
+   * @param size The number of bytes to allocate.
+   * @return A pointer to `size` contiguous bytes, or nullptr if the ring
+   * doesn't have that much room left.
+   *
+   * The bytes are only readable by the consumer after `commit()`.
+   */
+  void *alloc(size_t size) {
+    if (size > size_)
+      return nullptr;
+    if (pending_ + size - cached_tail_ > size_) {
+      cached_tail_ = tail_.load(acquire);
+      if (pending_ + size - cached_tail_ > size_)
+        return nullptr;
+    }
+    char *ptr = data + (pending_ & (size_ - 1));
+    pending_ += size;
+    return ptr;
+  }
+
+  /**
+   * @brief Makes every byte allocated so far readable by the consumer.
+   * Producer only.
+   */
+  void commit() { head_.store(pending_, release); }
+
+  /**
+   * @brief Returns every committed byte that wasn't consumed yet, oldest
+   * first, as one contiguous span. Consumer only.
+   */
+  std::span<char> readable() {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    cached_head_ = head_.load(acquire);
+    return {data + (tail & (size_ - 1)), cached_head_ - tail};
+  }
+
+  /**
+   * @brief Releases the oldest `size` readable bytes. Consumer only.
+   * @param size The number of bytes to release, atmost `readable().size()`.
+   */
+  void consume(size_t size) {
+    tail_.store(tail_.load(std::memory_order_relaxed) + size, release);
+  }
+
+  /**
+   * @brief Checks whether there is no committed byte left. Consumer only.
+   */
+  bool empty() {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == cached_head_)
+      cached_head_ = head_.load(acquire);
+    return tail == cached_head_;
+  }
+
+  /**
+   * @brief Releases every byte, committed or not.
+   *
+   * Neither the producer nor the consumer may use the arena meanwhile.
+   */
+  void reset() {
+    pending_ = cached_tail_ = cached_head_ = 0;
+    head_.store(0, release);
+    tail_.store(0, release);
+  }
+
+  /**
+   * @brief Returns the size of the ring in bytes.
+   */
+  size_t capacity() const { return size_; }
+
+private:
+  static constexpr std::memory_order acquire =
+      Concurrent ? std::memory_order_acquire : std::memory_order_relaxed;
+  static constexpr std::memory_order release =
+      Concurrent ? std::memory_order_release : std::memory_order_relaxed;
+
+  char *data = nullptr; ///< Start of the first of both mappings.
+  size_t size_;         ///< Size of the ring, a power of two.
+
+  // Producer side, kept away from the consumer's cache line.
+  alignas(64) std::atomic<size_t> head_{0}; ///< End of committed bytes.
+  size_t pending_ = 0;     ///< End of allocated bytes.
+  size_t cached_tail_ = 0; ///< Last tail seen by the producer.
+
+  // Consumer side.
+  alignas(64) std::atomic<size_t> tail_{0}; ///< Start of unconsumed bytes.
+  size_t cached_head_ = 0; ///< Last head seen by the consumer.
+};
+
+} // namespace Spektral::Arenas
@@ -0,0 +1,194 @@
+#pragma once
+#include "Backing.hpp"
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace Spektral::Arenas {
+
+/**
+ * @class RingArena
+ * @brief A FIFO ring buffer arena for streaming message allocation.
+ *
+ * Allocations are released in the order they were made: the producer bumps
+ * a head offset with `alloc()`, the consumer reads the oldest record with
+ * `front()` and releases it with `pop()`, which moves a tail offset. A record
+ * that would straddle the end of the buffer is placed at the start instead,
+ * and the space it skipped is released along with the record before it, so
+ * every payload is contiguous.
+ *
+ * Records become visible to the consumer once the producer calls `commit()`,
+ * which lets it fill the payload in place. With `Concurrent` set, one
+ * producer thread and one consumer thread can use the arena at the same time
+ * without locks.
+ *
+ * Every record has an 8 byte header and payloads are 8 bytes aligned.
+ *
+ * @tparam Concurrent Whether the producer and the consumer run on different
+ * threads. False by default.
+ */
+template <bool Concurrent = false> class RingArena {
+public:
+  /**
+   * @brief Deleted default constructor.
+   */
+  RingArena() = delete;
+
+  /**
+   * @brief Constructs a RingArena.
+   * @param size The size of the buffer in bytes, rounded up to a power of
+   * two.
+   * @param backing Where the memory comes from. `Backing::Heap` by default.
+   *
+   * Throws std::bad_alloc if allocation fails.
+   */
+  explicit RingArena(size_t size, Backing backing = Backing::Heap)
+      : size_(std::bit_ceil(size < 2 * header_size ? 2 * header_size : size)),
+        region_(size_, backing) {
+    if (!region_.commit(size_))
+      throw std::bad_alloc();
+    data = region_.data();
+  }
+
+  RingArena(const RingArena &) = delete;
+  RingArena &operator=(const RingArena &) = delete;
+
+  /**
+   * @brief Allocates a record at the head of the ring. Producer only.
+   * @param size The size of the payload in bytes.
+   * @return A pointer to the payload, or nullptr if the ring is full.
+   *
+   * The record is only visible to the consumer after `commit()`.
+   */
+  void *alloc(size_t size) {
+    if (size > size_ - header_size)
+      return nullptr;
+    size_t record = record_size(size);
+    size_t index = pending_ & (size_ - 1);
+    size_t skip = size_ - index < record ? size_ - index : 0;
+    if (pending_ + skip + record - cached_tail_ > size_) {
+      cached_tail_ = tail_.load(acquire);
+      if (pending_ + skip + record - cached_tail_ > size_)
+        return nullptr;
+    }
+    if (skip) {
+      header(index) = skip | skip_bit;
+      pending_ += skip;
+      index = 0;
+    }
+    header(index) = size;
+    pending_ += record;
+    return data + index + header_size;
+  }
+
+  /**
+   * @brief Allocates a record for an array of objects of type T. Producer
+   * only.
+   * @tparam T The type of object to allocate.
+   * @param count The number of objects to allocate.
+   * @return A pointer to the payload, or nullptr if the ring is full.
+   */
+  template <typename T> T *alloc(size_t count) {
+    static_assert(alignof(T) <= header_size,
+                  "RingArena payloads are only 8 bytes aligned");
+    if (count > size_ / (sizeof(T) ? sizeof(T) : 1))
+      return nullptr;
+    return static_cast<T *>(alloc(sizeof(T) * count));
+  }
+
+  /**
+   * @brief Makes every record allocated so far visible to the consumer.
+   * Producer only.
+   */
+  void commit() { head_.store(pending_, release); }
+
+  /**
+   * @brief Returns the oldest committed record. Consumer only.
+   * @param size If not null, receives the size of the payload.
+   * @return A pointer to the payload, or nullptr if there is no committed
+   * record.
+   */
+  void *front(size_t *size = nullptr) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == cached_head_) {
+      cached_head_ = head_.load(acquire);
+      if (tail == cached_head_)
+        return nullptr;
+    }
+    size_t index = tail & (size_ - 1);
+    if (header(index) & skip_bit) {
+      tail += header(index) & ~skip_bit;
+      tail_.store(tail, release);
+      index = 0;
+    }
+    if (size)
+      *size = header(index);
+    return data + index + header_size;
+  }
+
+  /**
+   * @brief Releases the oldest committed record. Consumer only.
+   * @return false if there is no committed record.
+   */
+  bool pop() {
+    if (!front())
+      return false;
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    tail_.store(tail + record_size(header(tail & (size_ - 1))), release);
+    return true;
+  }
+
+  /**
+   * @brief Checks whether there is no committed record. Consumer only.
+   */
+  bool empty() { return !front(); }
+
+  /**
+   * @brief Releases every record, committed or not.
+   *
+   * Neither the producer nor the consumer may use the arena meanwhile.
+   */
+  void reset() {
+    pending_ = cached_tail_ = cached_head_ = 0;
+    head_.store(0, release);
+    tail_.store(0, release);
+  }
+
+  /**
+   * @brief Returns the size of the buffer in bytes.
+   */
+  size_t capacity() const { return size_; }
+
+private:
+  static constexpr size_t header_size = sizeof(uint64_t);
+  static constexpr uint64_t skip_bit = uint64_t{1} << 63;
+  static constexpr std::memory_order acquire =
+      Concurrent ? std::memory_order_acquire : std::memory_order_relaxed;
+  static constexpr std::memory_order release =
+      Concurrent ? std::memory_order_release : std::memory_order_relaxed;
+
+  static size_t record_size(size_t size) {
+    return header_size + ((size + header_size - 1) & ~(header_size - 1));
+  }
+
+  uint64_t &header(size_t index) {
+    return *reinterpret_cast<uint64_t *>(data + index);
+  }
+
+  size_t size_;         ///< Size of the buffer, a power of two.
+  Region region_;       ///< Owner of the buffer.
+  char *data = nullptr; ///< Pointer to the buffer.
+
+  // Producer side, kept away from the consumer's cache line.
+  alignas(64) std::atomic<size_t> head_{0}; ///< End of committed records.
+  size_t pending_ = 0;     ///< End of allocated records.
+  size_t cached_tail_ = 0; ///< Last tail seen by the producer.
+
+  // Consumer side.
+  alignas(64) std::atomic<size_t> tail_{0}; ///< Start of the oldest record.
+  size_t cached_head_ = 0; ///< Last head seen by the consumer.
+};
+
+} // namespace Spektral::Arenas
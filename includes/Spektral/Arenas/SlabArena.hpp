@@ -0,0 +1,263 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace Spektral::Arenas {
+
+/**
+ * @class SlabArena
+ * @brief A general purpose arena with individual frees for mixed sizes.
+ *
+ * Requests are rounded up to one of 28 size classes between 16B and 4KB.
+ * Every class carves fixed-size blocks out of its own 64KB slabs and keeps
+ * freed blocks in an intrusive free list, so both `alloc` and `free` are
+ * O(1). Slabs are cut from large backing blocks which are allocated on demand
+ * and only given back to the system when the arena is destroyed.
+ *
+ * Slabs are aligned to their size and start with a small header holding
+ * their size class, which is how `free` finds the class of a block without
+ * being told its size.
+ *
+ * @note Only use with trivially destroyable types as destructors ARE NOT called
+ * when the arena goes out of scope. Use `destroy` to destroy and free a single
+ * object.
+ */
+class SlabArena {
+public:
+  /**
+   * @brief The size of a slab in bytes, slabs are aligned to it.
+   */
+  static constexpr size_t slab_size = 64 << 10;
+
+  /**
+   * @brief The largest allocation the arena can serve.
+   */
+  static constexpr size_t max_size = 4096;
+
+  /**
+   * @brief Deleted default constructor.
+   */
+  SlabArena() = delete;
+
+  /**
+   * @brief Constructs a SlabArena.
+   * @param size The size of every backing block in bytes, rounded up to a
+   * multiple of `slab_size`. 1MB by default.
+   *
+   * The first backing block is allocated right away, throws std::bad_alloc if
+   * that fails.
+   */
+  explicit SlabArena(size_t size = 1 << 20)
+      : backing_size_((size + slab_size - 1) / slab_size * slab_size) {
+    if (!backing_size_)
+      backing_size_ = slab_size;
+    if (!add_backing())
+      throw std::bad_alloc();
+  }
+
+  SlabArena(const SlabArena &) = delete;
+  SlabArena &operator=(const SlabArena &) = delete;
+
+  /**
+   * @brief Destructor that frees every backing block.
+   */
+  ~SlabArena() {
+    for (char *block : backing_)
+      ::free(block);
+  }
+
+  /**
+   * @brief Allocates a block of memory from the arena.
+   * @param size The number of bytes to allocate.
+   * @return A pointer to the allocated memory, 16 bytes aligned, or nullptr
+   * if `size` is bigger than `max_size` or out of memory.
+   */
+  inline void *alloc(size_t size) {
+    if (size > max_size)
+      return nullptr;
+    size_t size_class = class_table[(size + granularity - 1) / granularity];
+    Class &cls = classes_[size_class];
+    if (cls.free_list) {
+      FreeBlock *block = cls.free_list;
+      cls.free_list = block->next;
+      return block;
+    }
+    if (cls.cursor == cls.end && !new_slab(size_class))
+      return nullptr;
+    void *ptr = cls.cursor;
+    cls.cursor += class_sizes[size_class];
+    return ptr;
+  }
+
+  /**
+   * @brief Allocates memory for an array of objects of type T.
+   * @tparam T The type of object to allocate.
+   * @param count The number of objects to allocate.
+   * @return A pointer to the allocated memory, or nullptr if it doesn't fit
+   * in the largest size class or out of memory.
+   */
+  template <typename T> T *alloc(size_t count) {
+    static_assert(alignof(T) <= granularity,
+                  "SlabArena blocks are only 16 bytes aligned");
+    if (count > max_size / (sizeof(T) ? sizeof(T) : 1))
+      return nullptr;
+    return static_cast<T *>(alloc(sizeof(T) * count));
+  }
+
+  /**
+   * @brief Returns a block to its size class.
+   * @param ptr A pointer previously returned by `alloc` on this arena, or
+   * nullptr.
+   */
+  inline void free(void *ptr) {
+    if (!ptr)
+      return;
+    Slab *slab = reinterpret_cast<Slab *>(reinterpret_cast<uintptr_t>(ptr) &
+                                          ~(slab_size - 1));
+    FreeBlock *block = static_cast<FreeBlock *>(ptr);
+    Class &cls = classes_[slab->size_class];
+    block->next = cls.free_list;
+    cls.free_list = block;
+  }
+
+  /**
+   * @brief Creates and initializes a new object of type `T` inside the arena.
+   * @tparam T The type of the object to be constructed.
+   * @tparam Args The types of the arguments forwarded to the constructor.
+   * @param args Arguments to be forwarded to the constructor of `T`.
+   * @return A pointer to the new object, or nullptr if out of memory.
+   */
+  template <typename T, typename... Args> T *make(Args &&...args) {
+    T *ptr = alloc<T>(1);
+    return ptr ? new (ptr) T(std::forward<Args>(args)...) : nullptr;
+  }
+
+  /**
+   * @brief Destroys an object created by `make` and frees its block.
+   * @tparam T The type of the object.
+   * @param ptr The object to destroy, or nullptr.
+   */
+  template <typename T> void destroy(T *ptr) {
+    if (!ptr)
+      return;
+    ptr->~T();
+    free(ptr);
+  }
+
+  /**
+   * @brief Resets the memory arena.
+   *
+   * Makes every slab available again, the backing blocks are kept.
+   *
+   * Destructors won't be called.
+   */
+  void reset() {
+    classes_ = {};
+    current_backing_ = 0;
+    next_slab_ = backing_[0];
+  }
+
+  /**
+   * @brief Returns the size of the block `alloc(size)` would hand out.
+   * @param size The requested size in bytes, at most `max_size`.
+   */
+  static constexpr size_t block_size(size_t size) {
+    return class_sizes[class_table[(size + granularity - 1) / granularity]];
+  }
+
+private:
+  static constexpr size_t granularity = 16;
+  static constexpr size_t class_count = 28;
+
+  // 16B steps up to 128B, then four classes per power of two up to 4KB, which
+  // keeps internal fragmentation under 25%.
+  static constexpr std::array<uint16_t, class_count> class_sizes = [] {
+    std::array<uint16_t, class_count> sizes{};
+    size_t index = 0;
+    for (size_t size = 16; size <= 128; size += 16)
+      sizes[index++] = size;
+    for (size_t base = 128; base < max_size; base *= 2)
+      for (size_t step = 1; step <= 4; ++step)
+        sizes[index++] = base + base / 4 * step;
+    return sizes;
+  }();
+
+  // Maps a size, in units of 16 bytes and rounded up, to its size class.
+  static constexpr std::array<uint8_t, max_size / granularity + 1>
+      class_table = [] {
+        std::array<uint8_t, max_size / granularity + 1> table{};
+        size_t size_class = 0;
+        for (size_t units = 0; units < table.size(); ++units) {
+          while (class_sizes[size_class] < units * granularity)
+            ++size_class;
+          table[units] = size_class;
+        }
+        return table;
+      }();
+
+  static_assert(class_sizes[class_count - 1] == max_size);
+
+  /**
+   * @brief Header at the start of every slab.
+   */
+  struct alignas(granularity) Slab {
+    uint32_t size_class; ///< The size class of every block in the slab.
+  };
+
+  /**
+   * @brief Link stored inside every free block.
+   */
+  struct FreeBlock {
+    FreeBlock *next; ///< The next free block of the same class.
+  };
+
+  /**
+   * @brief Allocation state of a size class.
+   */
+  struct Class {
+    FreeBlock *free_list = nullptr; ///< Blocks freed by the user.
+    char *cursor = nullptr;         ///< Next never used block.
+    char *end = nullptr;            ///< End of the usable part of the slab.
+  };
+
+  // Slow path, hands the class a fresh slab.
+  bool new_slab(size_t size_class) {
+    if (next_slab_ == backing_[current_backing_] + backing_size_) {
+      if (current_backing_ + 1 == backing_.size() && !add_backing())
+        return false;
+      next_slab_ = backing_[++current_backing_];
+    }
+    Slab *slab = reinterpret_cast<Slab *>(next_slab_);
+    next_slab_ += slab_size;
+    slab->size_class = size_class;
+    size_t block = class_sizes[size_class];
+    Class &cls = classes_[size_class];
+    cls.cursor = reinterpret_cast<char *>(slab + 1);
+    cls.end = cls.cursor + (slab_size - sizeof(Slab)) / block * block;
+    return true;
+  }
+
+  bool add_backing() {
+    char *block =
+        static_cast<char *>(std::aligned_alloc(slab_size, backing_size_));
+    if (!block)
+      return false;
+    backing_.push_back(block);
+    if (backing_.size() == 1)
+      next_slab_ = block;
+    return true;
+  }
+
+  std::array<Class, class_count> classes_{}; ///< State of every size class.
+  std::vector<char *> backing_;              ///< Every backing block.
+  size_t current_backing_ = 0; ///< Backing block slabs are cut from.
+  char *next_slab_ = nullptr;  ///< Next free slab in that backing block.
+  size_t backing_size_;        ///< Size of every backing block.
+};
+
+} // namespace Spektral::Arenas
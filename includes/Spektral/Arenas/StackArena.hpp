@@ -0,0 +1,236 @@
+#pragma once
+#include "Backing.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace Spektral::Arenas {
+
+/**
+ * @class StackArena
+ * @brief A double-ended stack allocator over one contiguous block.
+ *
+ * Allocates from both ends of the same block: typically long-lived data from
+ * the bottom and temporaries from the top, so both share a single headroom.
+ * Each end is a stack, the most recent allocation on either end can be freed
+ * in O(1) with `pop_bottom()`, `pop_top()` or `free_last(ptr)`.
+ *
+ * To make that possible every allocation stores the previous offset of its
+ * end in one `size_t`: a footer right after it on the bottom end, a header
+ * right before it on the top end.
+ *
+ * @note Only use with trivially destroyable types as destructors ARE NOT called
+ * when the arena goes out of scope.
+ */
+class StackArena {
+public:
+  /**
+   * @brief Deleted default constructor.
+   */
+  StackArena() = delete;
+
+  /**
+   * @brief Constructs a StackArena with a given size.
+   * @param size The total size of the memory arena in bytes.
+   *
+   * Throws std::bad_alloc if allocation fails.
+   *
+   * @note Actual allocated size is based on `optimal_alloc(size)`
+   */
+  explicit StackArena(size_t size) : region_(size, Backing::Heap) {
+    data = region_.data();
+    size_ = region_.size() / sizeof(size_t) * sizeof(size_t);
+    top_ = size_;
+  }
+
+  StackArena(const StackArena &) = delete;
+  StackArena &operator=(const StackArena &) = delete;
+
+  /**
+   * @brief Allocates a block of memory from the bottom end.
+   * @param size The number of bytes to allocate.
+   * @param alignment The alignment of the block, a power of two. 1 by default.
+   * @return A pointer to the allocated memory, or nullptr if both ends would
+   * overlap.
+   */
+  void *alloc_bottom(size_t size, size_t alignment = 1) {
+    size_t start = align_up(bottom_, alignment);
+    if (start > top_ || size > top_ - start)
+      return nullptr;
+    size_t footer = align_up(start + size, sizeof(size_t));
+    if (footer > top_ || sizeof(size_t) > top_ - footer)
+      return nullptr;
+    memcpy(data + footer, &bottom_, sizeof(size_t));
+    bottom_ = footer + sizeof(size_t);
+    return data + start;
+  }
+
+  /**
+   * @brief Allocates a block of memory from the top end.
+   * @param size The number of bytes to allocate.
+   * @param alignment The alignment of the block, a power of two. 1 by default.
+   * @return A pointer to the allocated memory, or nullptr if both ends would
+   * overlap.
+   */
+  void *alloc_top(size_t size, size_t alignment = 1) {
+    if (size > top_ - bottom_)
+      return nullptr;
+    // The padding has to be checked before it is subtracted, with a large
+    // alignment it can be bigger than the offset itself.
+    size_t end = top_ - size;
+    size_t padding = misalignment(end, alignment);
+    if (padding > end - bottom_ || end - padding - bottom_ < sizeof(size_t))
+      return nullptr;
+    size_t start = end - padding;
+    size_t header = align_down(start - sizeof(size_t), sizeof(size_t));
+    if (header < bottom_)
+      return nullptr;
+    memcpy(data + header, &top_, sizeof(size_t));
+    top_ = header;
+    return data + start;
+  }
+
+  /**
+   * @brief Allocates memory for an array of objects of type T from the bottom
+   * end.
+   * @tparam T The type of object to allocate.
+   * @param count The number of objects to allocate.
+   * @return A pointer to the allocated memory, or nullptr if out of memory.
+   */
+  template <typename T> T *alloc_bottom(size_t count) {
+    if (count > size_ / (sizeof(T) ? sizeof(T) : 1))
+      return nullptr;
+    return static_cast<T *>(alloc_bottom(sizeof(T) * count, alignof(T)));
+  }
+
+  /**
+   * @brief Allocates memory for an array of objects of type T from the top
+   * end.
+   * @tparam T The type of object to allocate.
+   * @param count The number of objects to allocate.
+   * @return A pointer to the allocated memory, or nullptr if out of memory.
+   */
+  template <typename T> T *alloc_top(size_t count) {
+    if (count > size_ / (sizeof(T) ? sizeof(T) : 1))
+      return nullptr;
+    return static_cast<T *>(alloc_top(sizeof(T) * count, alignof(T)));
+  }
+
+  /**
+   * @brief Frees the most recent allocation of the bottom end.
+   * @return false if the bottom end is empty.
+   */
+  bool pop_bottom() {
+    if (!bottom_)
+      return false;
+    memcpy(&bottom_, data + bottom_ - sizeof(size_t), sizeof(size_t));
+    return true;
+  }
+
+  /**
+   * @brief Frees the most recent allocation of the top end.
+   * @return false if the top end is empty.
+   */
+  bool pop_top() {
+    if (top_ == size_)
+      return false;
+    memcpy(&top_, data + top_, sizeof(size_t));
+    return true;
+  }
+
+  /**
+   * @brief Frees `ptr` if it is the most recent allocation of its end.
+   * @param ptr A pointer returned by this arena.
+   * @return true if `ptr` was freed, false if it isn't the most recent
+   * allocation of either end.
+   */
+  bool free_last(void *ptr) {
+    size_t offset = static_cast<char *>(ptr) - data;
+    size_t previous;
+    if (offset < bottom_) {
+      memcpy(&previous, data + bottom_ - sizeof(size_t), sizeof(size_t));
+      return offset >= previous && pop_bottom();
+    }
+    if (offset >= top_ && top_ != size_) {
+      memcpy(&previous, data + top_, sizeof(size_t));
+      return offset <= previous && pop_top();
+    }
+    return false;
+  }
+
+  /**
+   * @brief Creates and initializes a new object of type `T` at the bottom
+   * end.
+   * @tparam T The type of the object to be constructed.
+   * @tparam Args The types of the arguments forwarded to the constructor.
+   * @param args Arguments to be forwarded to the constructor of `T`.
+   * @return A pointer to the new object, or nullptr if out of memory.
+   *
+   * @note Destructors won't get called.
+   */
+  template <typename T, typename... Args> T *make_bottom(Args &&...args) {
+    T *ptr = alloc_bottom<T>(1);
+    return ptr ? new (ptr) T(std::forward<Args>(args)...) : nullptr;
+  }
+
+  /**
+   * @brief Creates and initializes a new object of type `T` at the top end.
+   * @tparam T The type of the object to be constructed.
+   * @tparam Args The types of the arguments forwarded to the constructor.
+   * @param args Arguments to be forwarded to the constructor of `T`.
+   * @return A pointer to the new object, or nullptr if out of memory.
+   *
+   * @note Destructors won't get called.
+   */
+  template <typename T, typename... Args> T *make_top(Args &&...args) {
+    T *ptr = alloc_top<T>(1);
+    return ptr ? new (ptr) T(std::forward<Args>(args)...) : nullptr;
+  }
+
+  /**
+   * @brief Frees every allocation of the top end, the bottom end is kept.
+   */
+  void reset_top() { top_ = size_; }
+
+  /**
+   * @brief Resets both ends of the memory arena.
+   *
+   * Destructors won't be called.
+   */
+  void reset() {
+    bottom_ = 0;
+    top_ = size_;
+  }
+
+  /**
+   * @brief Returns the number of bytes left between both ends.
+   */
+  size_t remaining() const { return top_ - bottom_; }
+
+private:
+  // Alignment is computed on addresses, not offsets, so alignments bigger
+  // than the one of the block itself work too.
+  size_t align_up(size_t offset, size_t alignment) const {
+    uintptr_t address = reinterpret_cast<uintptr_t>(data) + offset;
+    return offset + (-address & (alignment - 1));
+  }
+
+  size_t misalignment(size_t offset, size_t alignment) const {
+    uintptr_t address = reinterpret_cast<uintptr_t>(data) + offset;
+    return address & (alignment - 1);
+  }
+
+  size_t align_down(size_t offset, size_t alignment) const {
+    return offset - misalignment(offset, alignment);
+  }
+
+  Region region_;       ///< Owner of the memory block.
+  char *data = nullptr; ///< Pointer to the allocated memory block.
+  size_t size_;         ///< The total size of the memory arena.
+  size_t bottom_ = 0;   ///< End of the bottom stack, grows up.
+  size_t top_;          ///< Start of the top stack, grows down.
+};
+
+} // namespace Spektral::Arenas
@@ -0,0 +1,82 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace Spektral::Arenas {
+
+/**
+ * @brief Stats policy that records nothing.
+ *
+ * Every hook is empty and the policy has no members, so an arena using it
+ * is exactly as fast and as big as one without stats.
+ */
+struct NoStats {
+  void record_alloc(size_t, size_t) {}
+  void record_failure(size_t) {}
+  void record_extend(size_t) {}
+  void record_usage(size_t) {}
+};
+
+/**
+ * @brief Stats policy that records how an arena is used.
+ *
+ * Meant to right-size arenas: the high-water mark survives `reset()`, so
+ * after a representative run it is the size the arena actually needed.
+ *
+ * A policy is any type with the four hooks below, an arena calls them on
+ * its allocation paths.
+ */
+struct ArenaStats {
+  /**
+   * @brief Number of buckets of the size histogram.
+   */
+  static constexpr size_t histogram_buckets = 65;
+
+  uint64_t bytes_requested = 0; ///< Sum of the sizes of every allocation.
+  uint64_t padding = 0;         ///< Bytes skipped to align allocations.
+  uint64_t allocations = 0;     ///< Number of successful allocations.
+  uint64_t failures = 0;        ///< Number of allocations that didn't fit.
+  uint64_t high_water_mark = 0; ///< Highest offset reached, across resets.
+  /// Allocations by size: bucket `i` counts sizes in `[2^(i-1), 2^i)`,
+  /// bucket 0 counts empty allocations.
+  std::array<uint64_t, histogram_buckets> histogram = {};
+
+  /**
+   * @brief Called for every successful allocation.
+   * @param size The number of bytes requested.
+   * @param padding The number of bytes skipped to align it.
+   */
+  void record_alloc(size_t size, size_t padding) {
+    bytes_requested += size;
+    this->padding += padding;
+    ++allocations;
+    ++histogram[std::bit_width(size)];
+  }
+
+  /**
+   * @brief Called for every allocation that failed.
+   * @param size The number of bytes requested.
+   */
+  void record_failure(size_t) { ++failures; }
+
+  /**
+   * @brief Called when the most recent allocation grows in place.
+   * @param added The number of bytes it grew by.
+   *
+   * Counted in `bytes_requested` but not as a new allocation.
+   */
+  void record_extend(size_t added) { bytes_requested += added; }
+
+  /**
+   * @brief Called whenever the arena's offset grows.
+   * @param used The new offset.
+   */
+  void record_usage(size_t used) {
+    if (used > high_water_mark)
+      high_water_mark = used;
+  }
+};
+
+} // namespace Spektral::Arenas
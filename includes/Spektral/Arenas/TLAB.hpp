@@ -0,0 +1,254 @@
+#pragma once
+#include "ConcurrentLinearArena.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace Spektral::Arenas {
+
+class TLAB;
+
+/**
+ * @class TLABArena
+ * @brief A shared arena that hands out thread-local allocation buffers.
+ *
+ * Threads don't allocate from this arena directly. Instead every thread owns a
+ * TLAB which bumps privately inside a chunk of `chunk_size` bytes, and only
+ * goes back to the shared ConcurrentLinearArena to grab a new chunk when its
+ * window is exhausted.
+ *
+ * `reset()` follows the same quiescence rules as
+ * ConcurrentLinearArena::reset(): no thread may be allocating or still using
+ * memory from the arena. It empties the window of every TLAB attached to the
+ * arena, so their next allocation grabs a fresh chunk.
+ */
+class TLABArena {
+public:
+  /**
+   * @brief Deleted default constructor.
+   */
+  TLABArena() = delete;
+
+  /**
+   * @brief Constructs a TLABArena.
+   * @param size The total size of the shared arena in bytes.
+   * @param chunk_size The size of the window a TLAB grabs on every refill,
+   * rounded up to a multiple of `sizeof(std::max_align_t)`. 4096 by default.
+   *
+   * Throws std::bad_alloc if allocation fails.
+   */
+  explicit TLABArena(size_t size, size_t chunk_size = 4096)
+      : shared_(size), chunk_size_(round_chunk(chunk_size)) {}
+
+  TLABArena(const TLABArena &) = delete;
+  TLABArena &operator=(const TLABArena &) = delete;
+
+  /**
+   * @brief Resets the shared arena and empties the window of every TLAB.
+   *
+   * NOT thread safe, see the class documentation for the quiescence rules.
+   */
+  void reset();
+
+  /**
+   * @brief Returns the size of the window grabbed on every refill.
+   */
+  size_t chunk_size() const { return chunk_size_; }
+
+  /**
+   * @brief Returns how many times any TLAB went to the shared arena.
+   */
+  size_t refills() const { return refills_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Returns the underlying shared arena.
+   */
+  ConcurrentLinearArena &shared() { return shared_; }
+
+private:
+  friend class TLAB;
+
+  // Chunks are claimed as whole `std::max_align_t`s, whose size can be
+  // bigger than their alignment (32 vs 16 on x86-64), so round to the size
+  // or the claimed chunk would be shorter than the window.
+  static size_t round_chunk(size_t size) {
+    constexpr size_t unit = sizeof(std::max_align_t);
+    return size ? (size + unit - 1) / unit * unit : unit;
+  }
+
+  ConcurrentLinearArena shared_;   ///< Where every chunk comes from.
+  size_t chunk_size_;              ///< Size of a single chunk.
+  std::atomic<size_t> refills_{0}; ///< Refills of every TLAB combined.
+  std::mutex attached_mutex_;      ///< Guards attached_.
+  TLAB *attached_ = nullptr;       ///< Intrusive list of every TLAB.
+};
+
+/**
+ * @class TLAB
+ * @brief A thread-local allocation buffer carved from a TLABArena.
+ *
+ * A TLAB must only be used by one thread at a time, the usual pattern is one
+ * `thread_local` TLAB per arena:
+ *
+ *     thread_local Spektral::Arenas::TLAB tlab(arena);
+ *
+ * Attaching and detaching take a mutex, allocating never does. Requests
+ * bigger than half a chunk bypass the window and go straight to the shared
+ * arena so they don't throw away what is left of it.
+ *
+ * @note Only use with trivially destroyable types as destructors ARE NOT called
+ * when the arena goes out of scope.
+ */
+class TLAB {
+public:
+  /**
+   * @brief Deleted default constructor.
+   */
+  TLAB() = delete;
+
+  /**
+   * @brief Attaches a new, empty TLAB to `arena`.
+   * @param arena The shared arena chunks are taken from. Must outlive the
+   * TLAB.
+   */
+  explicit TLAB(TLABArena &arena) : arena_(arena) {
+    std::lock_guard lock(arena_.attached_mutex_);
+    next_ = arena_.attached_;
+    if (next_)
+      next_->prev_ = this;
+    arena_.attached_ = this;
+  }
+
+  TLAB(const TLAB &) = delete;
+  TLAB &operator=(const TLAB &) = delete;
+
+  /**
+   * @brief Detaches the TLAB from its arena. Memory it handed out stays
+   * valid until the arena is reset.
+   */
+  ~TLAB() {
+    std::lock_guard lock(arena_.attached_mutex_);
+    if (prev_)
+      prev_->next_ = next_;
+    else
+      arena_.attached_ = next_;
+    if (next_)
+      next_->prev_ = prev_;
+  }
+
+  /**
+   * @brief Allocates a block of memory from the thread's window.
+   * @param size The number of bytes to allocate.
+   * @return A pointer to the allocated memory, or nullptr if the shared arena
+   * is out of memory.
+   */
+  inline void *alloc(size_t size) {
+    if (size > static_cast<size_t>(end_ - cursor_))
+      return refill(size, 1);
+    void *ptr = cursor_;
+    cursor_ += size;
+    return ptr;
+  }
+
+  /**
+   * @brief Allocates memory for an array of objects of type T.
+   * @tparam T The type of object to allocate.
+   * @param count The number of objects to allocate.
+   * @param align Define wether the block should be aligned. True by default.
+   * @return A pointer to the allocated memory, or nullptr if the shared arena
+   * is out of memory.
+   */
+  template <typename T> T *alloc(size_t count, bool align = true) {
+    size_t alignment = align ? alignof(T) : 1;
+    size_t required_size = sizeof(T) * count;
+    size_t padding = -reinterpret_cast<uintptr_t>(cursor_) & (alignment - 1);
+    if (padding + required_size > static_cast<size_t>(end_ - cursor_))
+      return static_cast<T *>(refill(required_size, alignment));
+    T *ptr = reinterpret_cast<T *>(cursor_ + padding);
+    cursor_ += padding + required_size;
+    return ptr;
+  }
+
+  /**
+   * @brief Allocates and zero-initializes memory for an array of objects of
+   * type T.
+   * @tparam T The type of object to allocate.
+   * @param blocks The number of objects to allocate.
+   * @return A pointer to the allocated memory, or nullptr if out of memory.
+   */
+  template <typename T> T *calloc(size_t blocks) {
+    T *ptr = alloc<T>(blocks);
+    if (ptr)
+      memset(ptr, 0, sizeof(T) * blocks);
+    return ptr;
+  }
+
+  /**
+   * @brief Creates and initializes a new object of type `T` inside the
+   * thread's window.
+   * @tparam T The type of the object to be constructed.
+   * @tparam Args The types of the arguments forwarded to the constructor.
+   * @param args Arguments to be forwarded to the constructor of `T`.
+   * @return A pointer to the new object, or nullptr if out of memory.
+   *
+   * @note Destructors won't get called.
+   */
+  template <typename T, typename... Args> T *make(Args &&...args) {
+    T *ptr = alloc<T>(1);
+    return ptr ? new (ptr) T(std::forward<Args>(args)...) : nullptr;
+  }
+
+  /**
+   * @brief Returns how many times this TLAB went to the shared arena.
+   */
+  size_t refills() const { return refills_; }
+
+private:
+  friend class TLABArena;
+
+  // Slow path, either grabs a new chunk or serves big requests directly from
+  // the shared arena.
+  void *refill(size_t size, size_t alignment) {
+    ++refills_;
+    arena_.refills_.fetch_add(1, std::memory_order_relaxed);
+    ConcurrentLinearArena &shared = arena_.shared_;
+    if (size > arena_.chunk_size_ / 2 ||
+        alignment > alignof(std::max_align_t)) {
+      char *ptr = shared.alloc<char>(size + alignment - 1);
+      if (!ptr)
+        return nullptr;
+      return ptr + (-reinterpret_cast<uintptr_t>(ptr) & (alignment - 1));
+    }
+    constexpr size_t unit = sizeof(std::max_align_t);
+    char *chunk = reinterpret_cast<char *>(
+        shared.alloc<std::max_align_t>(arena_.chunk_size_ / unit));
+    if (!chunk)
+      return nullptr;
+    cursor_ = chunk;
+    end_ = chunk + arena_.chunk_size_;
+    cursor_ += -reinterpret_cast<uintptr_t>(cursor_) & (alignment - 1);
+    void *ptr = cursor_;
+    cursor_ += size;
+    return ptr;
+  }
+
+  char *cursor_ = nullptr; ///< Next free byte in the window.
+  char *end_ = nullptr;    ///< End of the window.
+  size_t refills_ = 0;     ///< Number of trips to the shared arena.
+  TLABArena &arena_;       ///< The arena chunks come from.
+  TLAB *prev_ = nullptr;   ///< Previous TLAB attached to the same arena.
+  TLAB *next_ = nullptr;   ///< Next TLAB attached to the same arena.
+};
+
+inline void TLABArena::reset() {
+  std::lock_guard lock(attached_mutex_);
+  for (TLAB *tlab = attached_; tlab; tlab = tlab->next_)
+    tlab->cursor_ = tlab->end_ = nullptr;
+  shared_.reset();
+}
+
+} // namespace Spektral::Arenas
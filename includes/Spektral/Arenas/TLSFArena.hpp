@@ -0,0 +1,290 @@
+#pragma once
+#include "Backing.hpp"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace Spektral::Arenas {
+
+/**
+ * @class TLSFArena
+ * @brief A two-level segregated fit allocator over one contiguous region.
+ *
+ * Both `alloc` and `free` run in O(1) regardless of the state of the arena,
+ * which makes it suitable for threads with hard latency budgets. Free blocks
+ * are kept in segregated lists indexed by a first level (power of two) and a
+ * second level (32 linear subdivisions of it). Two levels of bitmaps and a
+ * count-trailing-zeros find a list that is guaranteed to fit the request, and
+ * freed blocks are immediately merged with their free neighbours.
+ *
+ * Every block carries a 16 byte header (previous physical block and size),
+ * allocations are 16 bytes aligned. Like every other arena in this library
+ * there are no locks, use one arena per thread.
+ *
+ * @note Destructors ARE NOT called when the arena goes out of scope. Use
+ * `destroy` to destroy and free a single object.
+ */
+class TLSFArena {
+public:
+  /**
+   * @brief Deleted default constructor.
+   */
+  TLSFArena() = delete;
+
+  /**
+   * @brief Constructs a TLSFArena.
+   * @param size The size of the region in bytes.
+   * @param backing Where the memory comes from. `Backing::Heap` by default.
+   *
+   * Throws std::bad_alloc if allocation fails.
+   */
+  explicit TLSFArena(size_t size, Backing backing = Backing::Heap)
+      : region_(size < 4 * header_size ? 4 * header_size : size, backing) {
+    if (!region_.commit(region_.size()))
+      throw std::bad_alloc();
+    data = region_.data();
+    size_ = region_.size() / alignment * alignment;
+    reset();
+  }
+
+  TLSFArena(const TLSFArena &) = delete;
+  TLSFArena &operator=(const TLSFArena &) = delete;
+
+  /**
+   * @brief Allocates a block of memory from the arena in O(1).
+   * @param size The number of bytes to allocate.
+   * @return A pointer to the allocated memory, or nullptr if no free block is
+   * big enough.
+   */
+  void *alloc(size_t size) {
+    if (size > max_alloc())
+      return nullptr;
+    size_t adjusted =
+        size < min_size ? min_size : (size + alignment - 1) & ~(alignment - 1);
+    // Round up to the next list boundary so any block found is big enough.
+    size_t rounded = adjusted;
+    if (rounded >= small_size)
+      rounded += (size_t{1} << (std::bit_width(rounded) - 1 - sl_shift)) - 1;
+    size_t fl, sl;
+    mapping(rounded, fl, sl);
+    Block *block = find(fl, sl);
+    if (!block) {
+      // Last chance, still O(1): the head of the request's own list may be
+      // big enough even though the list as a whole isn't guaranteed to be.
+      mapping(adjusted, fl, sl);
+      block = heads_[fl][sl];
+      if (!block || block->size() < adjusted)
+        return nullptr;
+    }
+    remove(block, fl, sl);
+    // Give back what is left if it can hold a block of its own.
+    if (block->size() >= adjusted + header_size + min_size) {
+      Block *rest = reinterpret_cast<Block *>(block->payload() + adjusted);
+      rest->prev_phys = block;
+      rest->size_ = block->size() - adjusted - header_size;
+      next_phys(rest)->prev_phys = rest;
+      block->size_ = adjusted;
+      insert(rest);
+    }
+    block->size_ &= ~free_bit;
+    return block->payload();
+  }
+
+  /**
+   * @brief Allocates memory for an array of objects of type T.
+   * @tparam T The type of object to allocate.
+   * @param count The number of objects to allocate.
+   * @return A pointer to the allocated memory, or nullptr if out of memory.
+   */
+  template <typename T> T *alloc(size_t count) {
+    static_assert(alignof(T) <= alignment,
+                  "TLSFArena blocks are only 16 bytes aligned");
+    if (count > max_alloc() / (sizeof(T) ? sizeof(T) : 1))
+      return nullptr;
+    return static_cast<T *>(alloc(sizeof(T) * count));
+  }
+
+  /**
+   * @brief Frees a block in O(1), merging it with its free neighbours.
+   * @param ptr A pointer previously returned by `alloc` on this arena, or
+   * nullptr.
+   */
+  void free(void *ptr) {
+    if (!ptr)
+      return;
+    Block *block = Block::from_payload(ptr);
+    Block *prev = block->prev_phys;
+    if (prev && prev->is_free()) {
+      remove(prev);
+      prev->size_ += header_size + block->size();
+      block = prev;
+    }
+    Block *next = next_phys(block);
+    if (next->is_free()) {
+      remove(next);
+      block->size_ += header_size + next->size();
+    }
+    next_phys(block)->prev_phys = block;
+    insert(block);
+  }
+
+  /**
+   * @brief Creates and initializes a new object of type `T` inside the arena.
+   * @tparam T The type of the object to be constructed.
+   * @tparam Args The types of the arguments forwarded to the constructor.
+   * @param args Arguments to be forwarded to the constructor of `T`.
+   * @return A pointer to the new object, or nullptr if out of memory.
+   */
+  template <typename T, typename... Args> T *make(Args &&...args) {
+    T *ptr = alloc<T>(1);
+    return ptr ? new (ptr) T(std::forward<Args>(args)...) : nullptr;
+  }
+
+  /**
+   * @brief Destroys an object created by `make` and frees its block.
+   * @tparam T The type of the object.
+   * @param ptr The object to destroy, or nullptr.
+   */
+  template <typename T> void destroy(T *ptr) {
+    if (!ptr)
+      return;
+    ptr->~T();
+    free(ptr);
+  }
+
+  /**
+   * @brief Resets the memory arena.
+   *
+   * Makes the whole region one free block again.
+   *
+   * Destructors won't be called.
+   */
+  void reset() {
+    fl_bitmap_ = 0;
+    for (size_t fl = 0; fl < fl_count; ++fl) {
+      sl_bitmap_[fl] = 0;
+      for (size_t sl = 0; sl < sl_count; ++sl)
+        heads_[fl][sl] = nullptr;
+    }
+    // One free block spanning the region, followed by a zero sized used
+    // sentinel so merging never runs past the end.
+    Block *block = reinterpret_cast<Block *>(data);
+    block->prev_phys = nullptr;
+    block->size_ = size_ - 2 * header_size;
+    Block *sentinel = next_phys(block);
+    sentinel->prev_phys = block;
+    sentinel->size_ = 0;
+    insert(block);
+  }
+
+  /**
+   * @brief Returns the size of the largest possible allocation.
+   */
+  size_t max_alloc() const { return size_ - 2 * header_size; }
+
+private:
+  static constexpr size_t alignment = 16;
+  static constexpr size_t sl_shift = 5;
+  static constexpr size_t sl_count = size_t{1} << sl_shift;
+  // Sizes below this are spread linearly over the second level of list 0.
+  static constexpr size_t small_size = sl_count * alignment;
+  static constexpr size_t fl_offset = std::bit_width(small_size) - 2;
+  static constexpr size_t fl_count = 64 - fl_offset;
+  static constexpr size_t free_bit = 1;
+
+  /**
+   * @brief Header in front of every block. The free list links overlap the
+   * payload, so they only exist while the block is free.
+   */
+  struct Block {
+    Block *prev_phys; ///< The block right before this one in memory.
+    size_t size_;     ///< Payload size, the low bit is set if free.
+    Block *next_free; ///< The next block in the same free list.
+    Block *prev_free; ///< The previous block in the same free list.
+
+    size_t size() const { return size_ & ~free_bit; }
+    bool is_free() const { return size_ & free_bit; }
+    char *payload() { return reinterpret_cast<char *>(this) + header_size; }
+    static Block *from_payload(void *ptr) {
+      return reinterpret_cast<Block *>(static_cast<char *>(ptr) - header_size);
+    }
+  };
+
+  static constexpr size_t header_size = offsetof(Block, next_free);
+  static constexpr size_t min_size = sizeof(Block) - header_size;
+
+  static Block *next_phys(Block *block) {
+    return reinterpret_cast<Block *>(block->payload() + block->size());
+  }
+
+  static void mapping(size_t size, size_t &fl, size_t &sl) {
+    if (size < small_size) {
+      fl = 0;
+      sl = size / alignment;
+      return;
+    }
+    size_t log2 = std::bit_width(size) - 1;
+    sl = (size >> (log2 - sl_shift)) ^ sl_count;
+    fl = log2 - fl_offset;
+  }
+
+  Block *find(size_t &fl, size_t &sl) const {
+    if (fl >= fl_count)
+      return nullptr;
+    uint32_t sl_map = sl_bitmap_[fl] & (~uint32_t{0} << sl);
+    if (!sl_map) {
+      uint64_t fl_map =
+          fl + 1 < fl_count ? fl_bitmap_ & (~uint64_t{0} << (fl + 1)) : 0;
+      if (!fl_map)
+        return nullptr;
+      fl = std::countr_zero(fl_map);
+      sl_map = sl_bitmap_[fl];
+    }
+    sl = std::countr_zero(sl_map);
+    return heads_[fl][sl];
+  }
+
+  void insert(Block *block) {
+    size_t fl, sl;
+    mapping(block->size(), fl, sl);
+    block->size_ |= free_bit;
+    block->prev_free = nullptr;
+    block->next_free = heads_[fl][sl];
+    if (block->next_free)
+      block->next_free->prev_free = block;
+    heads_[fl][sl] = block;
+    fl_bitmap_ |= uint64_t{1} << fl;
+    sl_bitmap_[fl] |= uint32_t{1} << sl;
+  }
+
+  void remove(Block *block) {
+    size_t fl, sl;
+    mapping(block->size(), fl, sl);
+    remove(block, fl, sl);
+  }
+
+  void remove(Block *block, size_t fl, size_t sl) {
+    if (block->prev_free)
+      block->prev_free->next_free = block->next_free;
+    else
+      heads_[fl][sl] = block->next_free;
+    if (block->next_free)
+      block->next_free->prev_free = block->prev_free;
+    if (!heads_[fl][sl]) {
+      sl_bitmap_[fl] &= ~(uint32_t{1} << sl);
+      if (!sl_bitmap_[fl])
+        fl_bitmap_ &= ~(uint64_t{1} << fl);
+    }
+  }
+
+  Region region_;                         ///< Owner of the memory block.
+  char *data = nullptr;                   ///< Start of the memory block.
+  size_t size_;                           ///< Usable size of the block.
+  uint64_t fl_bitmap_ = 0;                ///< Non-empty first level lists.
+  uint32_t sl_bitmap_[fl_count] = {};     ///< Non-empty second level lists.
+  Block *heads_[fl_count][sl_count] = {}; ///< Every segregated free list.
+};
+
+} // namespace Spektral::Arenas
@@ -1,8 +1,14 @@
+#pragma once
 #include <cmath>
 #include <cstddef>
 #include <unistd.h>
 
 namespace Spektral::Arenas {
+  /**
+   * @brief Size of a huge page, 2MB on x86-64 and most aarch64 kernels.
+   */
+  constexpr size_t huge_page_size = 2 << 20;
+
   /**
    * @brief Calculates the optimal allocation size based on user-defined
    * requirements.
@@ -17,8 +23,12 @@ namespace Spektral::Arenas {
    * - If none of the above conditions apply, it defaults to rounding up to the
    * nearest page size multiple, where the page size is obtained from the system
    * configuration.
+   * - If `huge_pages` is set, it rounds up to the nearest multiple of
+   * `huge_page_size`, since the tail of the last huge page is mapped anyway
+   * and would otherwise be wasted.
    *
    * @param user_sz The requested memory size in bytes.
+   * @param huge_pages Whether the block will be backed by huge pages.
    * @return A size_t value representing the optimal block size for allocation.
    *
    * @note This function internally uses `ceil` for rounding and `sysconf` to
@@ -27,7 +37,9 @@ namespace Spektral::Arenas {
    * relies on a for loop that can very easily be unrolled for more perf
    * so try doing that.
    */
-  inline size_t optimal_alloc(size_t user_sz) {
+  inline size_t optimal_alloc(size_t user_sz, bool huge_pages = false) {
+    if (huge_pages)
+      return (user_sz + huge_page_size - 1) / huge_page_size * huge_page_size;
     // Malloc internally provides the following list of block sizes:
     // 2**N; N in [5, 13) or (32, 4096]
     for (int ii = 5; ii < 13; ++ii)
@@ -36,7 +48,7 @@ namespace Spektral::Arenas {
     // If greater than 1MB, it will be 1MB + 512KB * K
     if (user_sz >= 1 << 20) {
       return (1 << 20) + (512 * 1 << 10) *
-                             ceil(user_sz - (1 << 20) * 1.0 / (512 * 1 << 10));
+                             ceil((user_sz - (1 << 20)) * 1.0 / (512 * 1 << 10));
     }
     // Or, multiples of the page size
     long page_size = sysconf(_SC_PAGE_SIZE);
@@ -1,8 +1,23 @@
+#include <Spektral/Arenas/ArenaHashMap.hpp>
+#include <Spektral/Arenas/BlockArena.hpp>
+#include <Spektral/Arenas/InlineArena.hpp>
 #include <Spektral/Arenas/LinearArena.hpp>
+#include <Spektral/Arenas/MemoryResource.hpp>
+#include <Spektral/Arenas/SlabArena.hpp>
+#include <Spektral/Arenas/TLSFArena.hpp>
+#include <algorithm>
+#include <array>
 #include <benchmark/benchmark.h>
+#include <chrono>
+#include <memory_resource>
+#include <random>
+#include <unordered_map>
 #define NUM_ITERS 1000000
 #define NUM_REPS 50
 #define BLOCK_SIZE 40
+#define LATENCY_SLOTS 4096
+#define SCRATCH_SIZE 256
+#define BATCH_SIZE 64
 
 void malloc_test(benchmark::State &state) {
   std::vector<void *> ptrs;
@@ -21,6 +36,152 @@ void linear_alloc_test(benchmark::State &state) {
   }
 }
 
+void linear_stats_alloc_test(benchmark::State &state) {
+  Spektral::Arenas::BasicLinearArena<Spektral::Arenas::ArenaStats> arena{
+      NUM_ITERS * BLOCK_SIZE};
+  for (auto _ : state) {
+    auto v = arena.alloc(BLOCK_SIZE);
+    benchmark::DoNotOptimize(v);
+  }
+}
+
+// Same number of blocks as linear_alloc_test, BATCH_SIZE per bounds check.
+void linear_alloc_n_test(benchmark::State &state) {
+  Spektral::Arenas::LinearArena arena{NUM_ITERS * BLOCK_SIZE};
+  for (auto _ : state) {
+    for (void *v : arena.alloc_n(BLOCK_SIZE, BATCH_SIZE))
+      benchmark::DoNotOptimize(v);
+  }
+}
+
+void linear_alloc_batch_test(benchmark::State &state) {
+  Spektral::Arenas::LinearArena arena{NUM_ITERS * BLOCK_SIZE};
+  std::array<char *, BATCH_SIZE> out;
+  for (auto _ : state) {
+    arena.alloc_batch<char>(BLOCK_SIZE, std::span(out));
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+}
+
+void block_alloc_test(benchmark::State &state) {
+  Spektral::Arenas::BlockArena arena{BLOCK_SIZE, NUM_ITERS};
+  for (auto _ : state) {
+    auto v = arena.alloc();
+    benchmark::DoNotOptimize(v);
+  }
+}
+
+void slab_alloc_test(benchmark::State &state) {
+  Spektral::Arenas::SlabArena arena{NUM_ITERS * BLOCK_SIZE};
+  for (auto _ : state) {
+    auto v = arena.alloc(BLOCK_SIZE);
+    benchmark::DoNotOptimize(v);
+  }
+}
+
+void pmr_monotonic_test(benchmark::State &state) {
+  std::pmr::monotonic_buffer_resource resource{NUM_ITERS * BLOCK_SIZE};
+  for (auto _ : state) {
+    auto v = resource.allocate(BLOCK_SIZE, alignof(void *));
+    benchmark::DoNotOptimize(v);
+  }
+}
+
+void pmr_arena_test(benchmark::State &state) {
+  Spektral::Arenas::LinearArena arena{NUM_ITERS * BLOCK_SIZE};
+  Spektral::Arenas::ArenaResource resource{arena};
+  for (auto _ : state) {
+    auto v = resource.allocate(BLOCK_SIZE, alignof(void *));
+    benchmark::DoNotOptimize(v);
+  }
+}
+
+// Every iteration creates a short lived scratch arena, uses it a little and
+// drops it.
+void linear_scratch_test(benchmark::State &state) {
+  for (auto _ : state) {
+    Spektral::Arenas::LinearArena arena{SCRATCH_SIZE};
+    auto v = arena.alloc<int>(4);
+    benchmark::DoNotOptimize(v);
+  }
+}
+
+void inline_scratch_test(benchmark::State &state) {
+  for (auto _ : state) {
+    Spektral::Arenas::InlineArena<SCRATCH_SIZE> arena;
+    auto v = arena.alloc<int>(4);
+    benchmark::DoNotOptimize(v);
+  }
+}
+
+// Every iteration inserts a new key, the map keeps growing.
+void unordered_map_insert_test(benchmark::State &state) {
+  std::unordered_map<uint64_t, uint64_t> map;
+  uint64_t i = 0;
+  for (auto _ : state) {
+    uint64_t key = i++ * 0x9E3779B97F4A7C15ull;
+    auto v = map.try_emplace(key, key);
+    benchmark::DoNotOptimize(v);
+  }
+}
+
+void arena_hashmap_insert_test(benchmark::State &state) {
+  Spektral::Arenas::LinearArena arena{size_t{256} << 20};
+  Spektral::Arenas::ArenaHashMap<uint64_t, uint64_t> map{arena};
+  uint64_t i = 0;
+  for (auto _ : state) {
+    uint64_t key = i++ * 0x9E3779B97F4A7C15ull;
+    auto v = map.try_emplace(key, key);
+    benchmark::DoNotOptimize(v);
+  }
+}
+
+// Every iteration frees a random live slot and refills it with a block of
+// random size, timing each pair on its own to report tail latency.
+template <typename Alloc, typename Free>
+void latency_test(benchmark::State &state, Alloc alloc, Free free) {
+  std::mt19937 rng{42};
+  std::uniform_int_distribution<size_t> sizes{16, 4096};
+  std::vector<void *> slots(LATENCY_SLOTS, nullptr);
+  std::vector<double> samples;
+  samples.reserve(state.max_iterations);
+  for (auto _ : state) {
+    size_t slot = rng() % LATENCY_SLOTS;
+    size_t size = sizes(rng);
+    auto start = std::chrono::steady_clock::now();
+    free(slots[slot]);
+    slots[slot] = alloc(size);
+    auto end = std::chrono::steady_clock::now();
+    benchmark::DoNotOptimize(slots[slot]);
+    samples.push_back(std::chrono::duration<double, std::nano>(end - start)
+                          .count());
+  }
+  for (auto p : slots)
+    free(p);
+  std::sort(samples.begin(), samples.end());
+  state.counters["p99_ns"] = samples[samples.size() * 99 / 100];
+  state.counters["p99.9_ns"] = samples[samples.size() * 999 / 1000];
+  state.counters["max_ns"] = samples.back();
+}
+
+void malloc_latency_test(benchmark::State &state) {
+  latency_test(
+      state, [](size_t size) { return malloc(size); },
+      [](void *p) { free(p); });
+}
+
+void tlsf_latency_test(benchmark::State &state) {
+  Spektral::Arenas::TLSFArena arena{LATENCY_SLOTS * 4096 * 2};
+  // Fault every page in up front, page faults aren't what's being measured
+  void *all = arena.alloc(arena.max_alloc());
+  memset(all, 0, arena.max_alloc());
+  arena.free(all);
+  latency_test(
+      state, [&](size_t size) { return arena.alloc(size); },
+      [&](void *p) { arena.free(p); });
+}
+
 BENCHMARK(malloc_test)
     ->Iterations(NUM_ITERS)
     ->Repetitions(NUM_REPS)
@@ -29,4 +190,56 @@ BENCHMARK(linear_alloc_test)
     ->Iterations(NUM_ITERS)
     ->Repetitions(NUM_REPS)
     ->ReportAggregatesOnly();
+BENCHMARK(linear_stats_alloc_test)
+    ->Iterations(NUM_ITERS)
+    ->Repetitions(NUM_REPS)
+    ->ReportAggregatesOnly();
+BENCHMARK(linear_alloc_n_test)
+    ->Iterations(NUM_ITERS / BATCH_SIZE)
+    ->Repetitions(NUM_REPS)
+    ->ReportAggregatesOnly();
+BENCHMARK(linear_alloc_batch_test)
+    ->Iterations(NUM_ITERS / BATCH_SIZE)
+    ->Repetitions(NUM_REPS)
+    ->ReportAggregatesOnly();
+BENCHMARK(block_alloc_test)
+    ->Iterations(NUM_ITERS)
+    ->Repetitions(NUM_REPS)
+    ->ReportAggregatesOnly();
+BENCHMARK(slab_alloc_test)
+    ->Iterations(NUM_ITERS)
+    ->Repetitions(NUM_REPS)
+    ->ReportAggregatesOnly();
+BENCHMARK(pmr_monotonic_test)
+    ->Iterations(NUM_ITERS)
+    ->Repetitions(NUM_REPS)
+    ->ReportAggregatesOnly();
+BENCHMARK(pmr_arena_test)
+    ->Iterations(NUM_ITERS)
+    ->Repetitions(NUM_REPS)
+    ->ReportAggregatesOnly();
+BENCHMARK(linear_scratch_test)
+    ->Iterations(NUM_ITERS)
+    ->Repetitions(NUM_REPS)
+    ->ReportAggregatesOnly();
+BENCHMARK(inline_scratch_test)
+    ->Iterations(NUM_ITERS)
+    ->Repetitions(NUM_REPS)
+    ->ReportAggregatesOnly();
+BENCHMARK(unordered_map_insert_test)
+    ->Iterations(NUM_ITERS)
+    ->Repetitions(NUM_REPS)
+    ->ReportAggregatesOnly();
+BENCHMARK(arena_hashmap_insert_test)
+    ->Iterations(NUM_ITERS)
+    ->Repetitions(NUM_REPS)
+    ->ReportAggregatesOnly();
+BENCHMARK(malloc_latency_test)
+    ->Iterations(NUM_ITERS)
+    ->Repetitions(NUM_REPS)
+    ->ReportAggregatesOnly();
+BENCHMARK(tlsf_latency_test)
+    ->Iterations(NUM_ITERS)
+    ->Repetitions(NUM_REPS)
+    ->ReportAggregatesOnly();
 BENCHMARK_MAIN();